@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "../include/orc.h"
+#include "../include/knight.h"
+#include "../include/bear.h"
+#include "../include/world.h"
+#include "../include/fight_manager.h"
+
+// Рождение и смерть range(0) NPC за итерацию: отдельные make_shared
+// против слотов арены мира, которые после смерти возвращаются через release.
+
+namespace {
+
+// Событие боя до перехода на ссылки мира
+struct SharedFightEvent {
+    std::shared_ptr<NPC> attacker;
+    std::shared_ptr<NPC> defender;
+};
+
+void BM_SharedNpcChurn(benchmark::State &state) {
+    const size_t n = state.range(0);
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            int c = static_cast<int>(i % 500);
+            switch (i % 3) {
+                case 0: npcs.push_back(std::make_shared<Orc>(c, c, "Grom")); break;
+                case 1: npcs.push_back(std::make_shared<Knight>(c, c, "Arthur")); break;
+                default: npcs.push_back(std::make_shared<Bear>(c, c, "Baloo")); break;
+            }
+        }
+        for (auto &npc : npcs)
+            npc->must_die();
+        npcs.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_WorldSlotChurn(benchmark::State &state) {
+    const size_t n = state.range(0);
+    World world(500, 500);
+    world.reserve(n);
+    std::vector<EntityId> ids;
+    ids.reserve(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            int c = static_cast<int>(i % 500);
+            ids.push_back(world.spawn(static_cast<NpcType>(OrcType + i % 3), c, c, "Grom"));
+        }
+        for (EntityId id : ids) {
+            world.kill(id);
+            world.release(id);
+        }
+        ids.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Копирование событий в пачку: пара shared_ptr (два атомарных инкремента
+// и декремента) против пары ссылок по 8 байт
+void BM_SharedFightEventCopy(benchmark::State &state) {
+    const size_t n = state.range(0);
+    auto orc = std::make_shared<Orc>(0, 0, "Grom");
+    auto bear = std::make_shared<Bear>(0, 0, "Baloo");
+    std::vector<SharedFightEvent> batch;
+    batch.reserve(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i)
+            batch.push_back({orc, bear});
+        benchmark::DoNotOptimize(batch.data());
+        batch.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_HandleFightEventCopy(benchmark::State &state) {
+    const size_t n = state.range(0);
+    World world(500, 500);
+    EntityHandle orc = world.handle(world.spawn(OrcType, 0, 0, "Grom"));
+    EntityHandle bear = world.handle(world.spawn(BearType, 0, 0, "Baloo"));
+    std::vector<FightEvent> batch;
+    batch.reserve(n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i)
+            batch.push_back({orc, bear});
+        benchmark::DoNotOptimize(batch.data());
+        batch.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+}
+
+BENCHMARK(BM_SharedNpcChurn)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_WorldSlotChurn)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_SharedFightEventCopy)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_HandleFightEventCopy)->Arg(10000)->Arg(100000);
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "../include/chunked_world.h"
+#include "../include/rng.h"
+
+// Чанковый мир: цена выгрузки/загрузки чанка и такт на карте
+// 1000000x1000000, где в памяти помещается лишь часть населённых чанков.
+
+namespace {
+
+// Бюджет в один байт: каждый touch загружает один чанк и выгружает другой
+void BM_ChunkPageRoundTrip(benchmark::State &state) {
+    const int n = static_cast<int>(state.range(0));
+    SimulationConfig map;
+    map.max_x = map.max_y = 10000;
+    ChunkConfig config;
+    config.chunk_size = 1000;
+    ChunkedWorld world(map, config);
+    for (int i = 0; i < n; ++i) {
+        world.spawn(OrcType, i % 1000, (i / 1000) % 1000, "Grom");
+        world.spawn(BearType, 5000 + i % 1000, (i / 1000) % 1000, "Baloo");
+    }
+    world.set_memory_budget(1);
+    bool left = true;
+    for (auto _ : state) {
+        world.touch(left ? 0 : 5000, 0);
+        left = !left;
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["page_ins"] = static_cast<double>(world.stats().page_ins);
+}
+
+// Кластеры по 200 NPC, бюджет - на четверть из них; фокус touch обходит
+// кластеры по кругу и тянет их с диска
+void BM_ChunkedWorldTick(benchmark::State &state) {
+    const size_t clusters = static_cast<size_t>(state.range(0));
+    const int size = 1000000;
+    SimulationConfig map;
+    map.seed = 11;
+    map.max_x = map.max_y = size;
+    ChunkConfig config;
+    config.chunk_size = 1000;
+    ChunkedWorld world(map, config);
+    CounterRng rng(3, 0);
+    std::vector<std::pair<int, int>> centers;
+    for (size_t c = 0; c < clusters; ++c) {
+        int cx = static_cast<int>(rng.uniform(size - 1000)) + 500;
+        int cy = static_cast<int>(rng.uniform(size - 1000)) + 500;
+        centers.emplace_back(cx, cy);
+        for (int i = 0; i < 200; ++i)
+            world.spawn(static_cast<NpcType>(OrcType + i % 3),
+                        cx + static_cast<int>(rng.uniform(400)) - 200,
+                        cy + static_cast<int>(rng.uniform(400)) - 200);
+    }
+    world.set_memory_budget(world.stats().resident_bytes / 4);
+
+    size_t tick = 0;
+    for (auto _ : state) {
+        auto [fx, fy] = centers[tick % centers.size()];
+        world.touch(fx, fy, 1);
+        world.tick(tick++);
+    }
+    ChunkStats s = world.stats();
+    state.SetItemsProcessed(state.iterations() * world.population());
+    state.counters["resident"] = static_cast<double>(s.resident);
+    state.counters["paged"] = static_cast<double>(s.paged);
+    state.counters["page_ins"] = benchmark::Counter(static_cast<double>(s.page_ins), benchmark::Counter::kAvgIterations);
+    state.counters["resident_mb"] = static_cast<double>(s.resident_bytes) / (1 << 20);
+}
+
+}
+
+BENCHMARK(BM_ChunkPageRoundTrip)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ChunkedWorldTick)->Arg(500)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,192 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+#include "../include/fight_manager.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Прежняя реализация FightManager: std::queue под эксклюзивным shared_mutex
+// и опрос со sleep_for(100ms), пока очередь пуста
+class LockedQueue {
+public:
+    void push(FightEvent &&event) {
+        std::lock_guard<std::shared_mutex> lock(mtx);
+        events.push(std::move(event));
+    }
+
+    std::optional<FightEvent> pop() {
+        std::lock_guard<std::shared_mutex> lock(mtx);
+        if (events.empty())
+            return std::nullopt;
+        FightEvent event = std::move(events.front());
+        events.pop();
+        return event;
+    }
+
+private:
+    std::queue<FightEvent> events;
+    std::shared_mutex mtx;
+};
+
+class LockFreeQueue {
+public:
+    void push(FightEvent &&event) {
+        while (!events.try_push(std::move(event)))
+            std::this_thread::yield();
+        ready.notify();
+    }
+
+    std::optional<FightEvent> pop() {
+        FightEvent event;
+        if (events.try_pop(event))
+            return event;
+        return std::nullopt;
+    }
+
+    // Блокирующее ожидание, как в FightManager::operator()
+    FightEvent pop_wait() {
+        for (;;) {
+            if (auto event = pop())
+                return std::move(*event);
+            auto key = ready.prepare_wait();
+            if (!events.empty()) {
+                ready.cancel_wait();
+                continue;
+            }
+            ready.wait(key);
+        }
+    }
+
+private:
+    MpscQueue<FightEvent> events{1 << 16};
+    EventCount ready;
+};
+
+FightEvent make_event() {
+    return {{0, 0}, {1, 0}};
+}
+
+// range(0) производителей кладут по ITEMS событий, один поток разбирает
+template <typename Queue>
+void BM_QueueThroughput(benchmark::State &state) {
+    const size_t producers = state.range(0);
+    const size_t ITEMS = 100000;
+    for (auto _ : state) {
+        Queue queue;
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, ITEMS]() {
+                for (size_t i = 0; i < ITEMS; ++i)
+                    queue.push(make_event());
+            });
+        }
+        size_t received = 0;
+        while (received < producers * ITEMS) {
+            if (queue.pop())
+                ++received;
+            else
+                std::this_thread::yield();
+        }
+        for (auto &t : threads)
+            t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * producers * ITEMS);
+}
+
+// Задержка от постановки события до того, как его получил спящий потребитель
+void BM_WakeLatencyPolling(benchmark::State &state) {
+    LockedQueue queue;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> acked{0};
+    std::thread consumer([&]() {
+        while (!done) {
+            if (queue.pop())
+                ++acked;
+            else
+                std::this_thread::sleep_for(100ms);
+        }
+    });
+    size_t sent = 0;
+    for (auto _ : state) {
+        queue.push(make_event());
+        ++sent;
+        while (acked < sent)
+            std::this_thread::yield();
+    }
+    done = true;
+    consumer.join();
+}
+
+void BM_WakeLatencyEventCount(benchmark::State &state) {
+    LockFreeQueue queue;
+    std::atomic<size_t> acked{0};
+    std::thread consumer([&]() {
+        // Пустое событие - сигнал остановки
+        while (queue.pop_wait().defender.id != 0)
+            ++acked;
+    });
+    size_t sent = 0;
+    for (auto _ : state) {
+        queue.push(make_event());
+        ++sent;
+        while (acked < sent)
+            std::this_thread::yield();
+    }
+    queue.push({});
+    consumer.join();
+}
+
+// Такт поиска соседей: range(0) близких пар, каждая найдена в обоих порядках
+// и держится три такта. Прежний путь ставит все упорядоченные пары,
+// add_candidate - одну каноническую на пару, пока она в полёте.
+void BM_EnqueueOrderedPairs(benchmark::State &state) {
+    const size_t pairs = state.range(0);
+    World world(500, 500);
+    for (size_t i = 0; i < pairs * 2; ++i)
+        world.spawn(i % 2 ? OrcType : KnightType, 0, 0);
+    FightManager manager(world);
+    for (auto _ : state) {
+        for (int tick = 0; tick < 3; ++tick) {
+            for (EntityId i = 0; i < pairs * 2; i += 2) {
+                manager.add_event({world.handle(i), world.handle(i + 1)});
+                manager.add_event({world.handle(i + 1), world.handle(i)});
+            }
+        }
+        benchmark::DoNotOptimize(manager.drain());
+    }
+    state.SetItemsProcessed(state.iterations() * pairs * 6);
+}
+
+void BM_EnqueueCandidates(benchmark::State &state) {
+    const size_t pairs = state.range(0);
+    World world(500, 500);
+    for (size_t i = 0; i < pairs * 2; ++i)
+        world.spawn(i % 2 ? OrcType : KnightType, 0, 0);
+    FightManager manager(world);
+    for (auto _ : state) {
+        for (int tick = 0; tick < 3; ++tick) {
+            for (EntityId i = 0; i < pairs * 2; i += 2) {
+                manager.add_candidate(i, i + 1);
+                manager.add_candidate(i + 1, i);
+            }
+        }
+        benchmark::DoNotOptimize(manager.drain());
+    }
+    state.SetItemsProcessed(state.iterations() * pairs * 6);
+}
+
+}
+
+BENCHMARK(BM_QueueThroughput<LockedQueue>)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_QueueThroughput<LockFreeQueue>)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_WakeLatencyPolling)->Iterations(20)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_WakeLatencyEventCount)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_EnqueueOrderedPairs)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_EnqueueCandidates)->Arg(1000)->Arg(10000);
@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include "../include/npc.h"
+#include "../include/orc.h"
+#include "../include/knight.h"
+#include "../include/bear.h"
+#include "../include/factory.h"
+#include "../include/fight_manager.h"
+#include "../include/fight_table.h"
+#include "../include/metrics.h"
+
+// Микробенчмарки горячих путей симуляции.
+// Параметры: range(0) - число NPC, range(1) - сторона карты (плотность).
+// JSON для сравнения между релизами: цель bench_json или
+//   bench --benchmark_out=bench.json --benchmark_out_format=json
+
+namespace {
+
+std::vector<std::shared_ptr<NPC>> make_npcs(size_t n, int map) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> coord(0, map);
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        int x = coord(gen), y = coord(gen);
+        switch (i % 3) {
+            case 0: npcs.push_back(std::make_shared<Orc>(x, y, "Grom")); break;
+            case 1: npcs.push_back(std::make_shared<Knight>(x, y, "Arthur")); break;
+            default: npcs.push_back(std::make_shared<Bear>(x, y, "Baloo")); break;
+        }
+    }
+    return npcs;
+}
+
+void BM_NpcMove(benchmark::State &state) {
+    const int map = state.range(1);
+    auto npcs = make_npcs(state.range(0), map);
+    int step = 0;
+    for (auto _ : state) {
+        int shift = (step++ % 2) ? 1 : -1;
+        for (auto &npc : npcs)
+            npc->move(shift, -shift, map, map);
+    }
+    state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+// Каждый NPC против 64 соседей по списку: доля близких пар зависит от плотности
+void BM_NpcIsClose(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), state.range(1));
+    const size_t window = std::min<size_t>(64, npcs.size());
+    for (auto _ : state) {
+        size_t close = 0;
+        for (size_t i = 0; i < npcs.size(); ++i)
+            for (size_t j = 1; j < window; ++j)
+                close += npcs[i]->is_close(npcs[(i + j) % npcs.size()], 10);
+        benchmark::DoNotOptimize(close);
+    }
+    state.SetItemsProcessed(state.iterations() * npcs.size() * (window - 1));
+}
+
+// Имя - string_view из таблицы: без блокировки и копирования строки
+void BM_NpcGetName(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), 500);
+    for (auto _ : state) {
+        size_t letters = 0;
+        for (auto &npc : npcs)
+            letters += npc->get_name().size();
+        benchmark::DoNotOptimize(letters);
+    }
+    state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+void BM_AcceptFight(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), 500);
+    for (auto _ : state) {
+        size_t wins = 0;
+        for (size_t i = 0; i + 1 < npcs.size(); ++i)
+            wins += npcs[i + 1]->accept(npcs[i]);
+        benchmark::DoNotOptimize(wins);
+    }
+    state.SetItemsProcessed(state.iterations() * (npcs.size() - 1));
+}
+
+void BM_ResolveFightTable(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), 500);
+    for (auto _ : state) {
+        size_t wins = 0;
+        for (size_t i = 0; i + 1 < npcs.size(); ++i)
+            wins += resolve_fight(npcs[i]->get_type(), npcs[i + 1]->get_type());
+        benchmark::DoNotOptimize(wins);
+    }
+    state.SetItemsProcessed(state.iterations() * (npcs.size() - 1));
+}
+
+// Очередь + разбор пачки; все бои - проигрыши, чтобы мир не менялся
+void BM_FightManagerEnqueueDrain(benchmark::State &state) {
+    World world(500, 500);
+    EntityHandle orc = world.handle(world.spawn(OrcType, 0, 0, "Grom"));
+    FightManager manager(world);
+    const size_t events = state.range(0);
+    for (auto _ : state) {
+        for (size_t i = 0; i < events; ++i)
+            manager.add_event({orc, orc});
+        benchmark::DoNotOptimize(manager.drain());
+    }
+    state.SetItemsProcessed(state.iterations() * events);
+}
+
+void BM_FactoryConstruct(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        World world(500, 500);
+        world.reserve(n);
+        std::vector<std::shared_ptr<NPC>> npcs;
+        npcs.reserve(n);
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i)
+            npcs.push_back(factory(world, static_cast<NpcType>(OrcType + i % 3), i % 500, i % 499));
+        benchmark::DoNotOptimize(npcs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_NpcSave(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), 500);
+    for (auto _ : state) {
+        std::ostringstream os;
+        for (auto &npc : npcs)
+            npc->save(os);
+        benchmark::DoNotOptimize(os.str().size());
+    }
+    state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+void BM_FactoryLoad(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0), 500);
+    std::ostringstream os;
+    for (auto &npc : npcs)
+        npc->save(os);
+    const std::string text = os.str();
+    for (auto _ : state) {
+        std::istringstream is(text);
+        size_t loaded = 0;
+        for (size_t i = 0; i < npcs.size(); ++i)
+            loaded += factory(is) != nullptr;
+        benchmark::DoNotOptimize(loaded);
+    }
+    state.SetItemsProcessed(state.iterations() * npcs.size());
+}
+
+// Цена инструментирования: таймер фазы и счётчик на одно событие
+void BM_ScopedTimer(benchmark::State &state) {
+    for (auto _ : state) {
+        ScopedTimer timer(MetricTimer::Observe);
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_MetricCounter(benchmark::State &state) {
+    for (auto _ : state)
+        metrics().add(MetricCounter::FightsResolved);
+}
+
+}
+
+BENCHMARK(BM_NpcMove)->ArgsProduct({{1000, 10000, 100000}, {500, 5000}});
+BENCHMARK(BM_NpcIsClose)->ArgsProduct({{1000, 10000, 100000}, {50, 500, 5000}});
+BENCHMARK(BM_NpcGetName)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_AcceptFight)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_ResolveFightTable)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_FightManagerEnqueueDrain)->Arg(1000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_FactoryConstruct)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_NpcSave)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_FactoryLoad)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_ScopedTimer);
+BENCHMARK(BM_MetricCounter);
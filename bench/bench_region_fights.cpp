@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "../include/world.h"
+#include "../include/spatial_grid.h"
+#include "../include/region_fights.h"
+
+namespace {
+
+const int MAP{2000};
+const int DISTANCE{10};
+
+void fill_world(World &world, size_t n, std::vector<FightPair> &fights) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> coord(0, MAP);
+    world.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        world.spawn(static_cast<NpcType>(OrcType + i % 3), coord(gen), coord(gen), "N");
+
+    SpatialGrid grid(MAP, MAP, DISTANCE);
+    for (EntityId id = 0; id < world.size(); ++id)
+        grid.insert(id, world.x(id), world.y(id));
+    fights.clear();
+    grid.for_each_candidate_pair([&](EntityId a, EntityId b) {
+        if (world.is_close(a, b, DISTANCE)) {
+            fights.push_back({a, b});
+            fights.push_back({b, a});
+        }
+    });
+}
+
+// range(0) - число NPC, range(1) - число потоков-регионов
+void BM_RegionFights(benchmark::State &state) {
+    std::vector<FightPair> fights;
+    size_t resolved = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        World world(MAP, MAP);
+        fill_world(world, state.range(0), fights);
+        RegionFightResolver resolver(world, state.range(1));
+        state.ResumeTiming();
+
+        resolved += resolver.resolve(fights).size();
+    }
+    state.counters["fights"] = static_cast<double>(fights.size());
+    state.SetItemsProcessed(state.iterations() * fights.size());
+    benchmark::DoNotOptimize(resolved);
+}
+
+}
+
+BENCHMARK(BM_RegionFights)
+    ->ArgsProduct({{100000, 400000}, {1, 2, 4, 8, 16, 32}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
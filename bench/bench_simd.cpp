@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../include/simd_kernels.h"
+#include "../include/npc.h"
+
+// Пакетные ядра на range(0) сущностях; range(1) - уровень SimdLevel.
+// Уровень выше поддерживаемого процессором понижается до доступного.
+
+namespace {
+
+struct Columns {
+    std::vector<int> xs, ys;
+    std::vector<std::uint8_t> types, alive, dirs;
+    std::vector<std::uint32_t> a, b;
+    std::vector<std::uint64_t> out;
+
+    explicit Columns(size_t n) : xs(n), ys(n), types(n), alive(n), dirs(n), a(n), b(n), out(n) {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<> coord(0, 500);
+        std::uniform_int_distribution<std::uint32_t> id(0, static_cast<std::uint32_t>(n - 1));
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = coord(gen);
+            ys[i] = coord(gen);
+            types[i] = static_cast<std::uint8_t>(OrcType + i % 3);
+            alive[i] = (gen() % 8) != 0;
+            dirs[i] = static_cast<std::uint8_t>(gen() & 3);
+            a[i] = id(gen);
+            b[i] = id(gen);
+        }
+    }
+};
+
+void BM_MoveBatch(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto level = static_cast<SimdLevel>(state.range(1));
+    Columns c(n);
+    MoveBatch batch{c.xs.data(), c.ys.data(), c.types.data(), c.alive.data(), c.dirs.data(), DEFAULT_MOVE_RANGES, n};
+    for (auto _ : state) {
+        move_batch(batch, 500, 500, level);
+        benchmark::DoNotOptimize(c.xs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(simd_level_name(std::min(level, detected_simd_level())));
+}
+
+void BM_SquaredDistances(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto level = static_cast<SimdLevel>(state.range(1));
+    Columns c(n);
+    for (auto _ : state) {
+        squared_distances(c.xs.data(), c.ys.data(), c.a.data(), c.b.data(), n, c.out.data(), level);
+        benchmark::DoNotOptimize(c.out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetLabel(simd_level_name(std::min(level, detected_simd_level())));
+}
+
+// range(1) - радиус: 10 идёт специализацией с константой, 11 - общим путём
+void BM_ClosePairs(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const int distance = static_cast<int>(state.range(1));
+    Columns c(n);
+    std::vector<std::uint32_t> found(n);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(close_pairs(c.xs.data(), c.ys.data(), c.a.data(), c.b.data(), n, distance, found.data()));
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+}
+
+BENCHMARK(BM_MoveBatch)->ArgsProduct({{10000, 100000}, {0, 1, 2}});
+BENCHMARK(BM_SquaredDistances)->ArgsProduct({{10000, 100000}, {0, 1, 2}});
+BENCHMARK(BM_ClosePairs)->ArgsProduct({{100000}, {10, 11}});
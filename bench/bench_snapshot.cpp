@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "../include/world.h"
+#include "../include/snapshot.h"
+#include "../include/orc.h"
+#include "../include/knight.h"
+#include "../include/bear.h"
+
+namespace {
+
+void fill_world(World &world, size_t n) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> coord(0, world.max_x());
+    world.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        world.spawn(static_cast<NpcType>(OrcType + i % 3), coord(gen), coord(gen));
+}
+
+std::string temp_path(const char *name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void BM_SaveText(benchmark::State &state) {
+    World world(500, 500);
+    fill_world(world, state.range(0));
+    auto path = temp_path("lab7_bench.txt");
+    for (auto _ : state) {
+        std::ofstream os(path);
+        save_text(world, os);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Прежний путь загрузки: NPC::NPC(istream) через operator>> и getline
+void BM_LoadTextNpc(benchmark::State &state) {
+    World world(500, 500);
+    fill_world(world, state.range(0));
+    auto path = temp_path("lab7_bench.txt");
+    {
+        std::ofstream os(path);
+        save_text(world, os);
+    }
+    for (auto _ : state) {
+        std::ifstream is(path);
+        std::vector<std::shared_ptr<NPC>> npcs;
+        int type{0};
+        while (is >> type) {
+            switch (type) {
+                case OrcType: npcs.push_back(std::make_shared<Orc>(is)); break;
+                case KnightType: npcs.push_back(std::make_shared<Knight>(is)); break;
+                case BearType: npcs.push_back(std::make_shared<Bear>(is)); break;
+            }
+        }
+        benchmark::DoNotOptimize(npcs.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LoadTextWorld(benchmark::State &state) {
+    World world(500, 500);
+    fill_world(world, state.range(0));
+    auto path = temp_path("lab7_bench.txt");
+    {
+        std::ofstream os(path);
+        save_text(world, os);
+    }
+    for (auto _ : state) {
+        std::ifstream is(path);
+        World loaded(500, 500);
+        benchmark::DoNotOptimize(load_text(loaded, is));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_SaveSnapshot(benchmark::State &state) {
+    World world(500, 500);
+    fill_world(world, state.range(0));
+    auto path = temp_path("lab7_bench.l7ws");
+    for (auto _ : state)
+        benchmark::DoNotOptimize(save_snapshot(world, path));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LoadSnapshot(benchmark::State &state) {
+    World world(500, 500);
+    fill_world(world, state.range(0));
+    auto path = temp_path("lab7_bench.l7ws");
+    save_snapshot(world, path);
+    for (auto _ : state) {
+        auto loaded = load_snapshot(path);
+        benchmark::DoNotOptimize(loaded->size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(BM_SaveText)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadTextNpc)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadTextWorld)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveSnapshot)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadSnapshot)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
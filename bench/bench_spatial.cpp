@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "../include/npc.h"
+#include "../include/orc.h"
+#include "../include/knight.h"
+#include "../include/bear.h"
+#include "../include/spatial_grid.h"
+
+namespace {
+
+const int MAX_X{500};
+const int MAX_Y{500};
+const size_t DISTANCE{10};
+
+std::vector<std::shared_ptr<NPC>> make_npcs(size_t n) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> coord(0, MAX_X);
+    std::vector<std::shared_ptr<NPC>> npcs;
+    npcs.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        int x = coord(gen), y = coord(gen);
+        switch (i % 3) {
+            case 0: npcs.push_back(std::make_shared<Orc>(x, y, "Grom")); break;
+            case 1: npcs.push_back(std::make_shared<Knight>(x, y, "Arthur")); break;
+            default: npcs.push_back(std::make_shared<Bear>(x, y, "Baloo")); break;
+        }
+    }
+    return npcs;
+}
+
+// Старый вариант из move_thread: все упорядоченные пары
+void BM_ProximityBruteForce(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0));
+    for (auto _ : state) {
+        size_t found = 0;
+        for (auto &npc : npcs)
+            for (auto &other : npcs)
+                if (other != npc && npc->is_close(other, DISTANCE))
+                    ++found;
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ProximityGrid(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0));
+    SpatialGrid grid(MAX_X, MAX_Y, DISTANCE);
+    for (SpatialGrid::id_t id = 0; id < npcs.size(); ++id) {
+        auto [x, y] = npcs[id]->position();
+        grid.insert(id, x, y);
+    }
+    for (auto _ : state) {
+        size_t found = 0;
+        grid.for_each_candidate_pair([&](SpatialGrid::id_t a, SpatialGrid::id_t b) {
+            if (npcs[a]->is_close(npcs[b], DISTANCE))
+                found += 2;
+        });
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Перестроение сетки с нуля против инкрементального обновления после шага
+void BM_GridRebuild(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0));
+    SpatialGrid grid(MAX_X, MAX_Y, DISTANCE);
+    for (auto _ : state) {
+        grid.clear();
+        for (SpatialGrid::id_t id = 0; id < npcs.size(); ++id) {
+            auto [x, y] = npcs[id]->position();
+            grid.insert(id, x, y);
+        }
+        benchmark::DoNotOptimize(grid.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_GridIncrementalMove(benchmark::State &state) {
+    auto npcs = make_npcs(state.range(0));
+    SpatialGrid grid(MAX_X, MAX_Y, DISTANCE);
+    for (SpatialGrid::id_t id = 0; id < npcs.size(); ++id) {
+        auto [x, y] = npcs[id]->position();
+        grid.insert(id, x, y);
+    }
+    int step = 0;
+    for (auto _ : state) {
+        int shift = (step++ % 2) ? 1 : -1;
+        for (SpatialGrid::id_t id = 0; id < npcs.size(); ++id) {
+            auto [old_x, old_y] = npcs[id]->position();
+            npcs[id]->move(shift, shift, MAX_X, MAX_Y);
+            auto [new_x, new_y] = npcs[id]->position();
+            grid.update(id, old_x, old_y, new_x, new_y);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+// Полный перебор на 100k занимает минуты: его можно отфильтровать через --benchmark_filter
+BENCHMARK(BM_ProximityBruteForce)->Arg(1000)->Arg(10000)->Arg(100000)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ProximityGrid)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GridRebuild)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GridIncrementalMove)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
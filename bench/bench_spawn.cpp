@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "../include/spawn_stage.h"
+#include "../include/simulation.h"
+
+// Непрерывное рождение: пачка range(0) NPC за такт на карте 2000x2000.
+// Цель - не меньше 100k рождений в секунду.
+
+namespace {
+
+// Только стадия: резерв столбцов, имена, вставка в сетку. Мир
+// пересоздаётся вне замера, когда дорастает до миллиона
+void BM_SpawnStage(benchmark::State &state) {
+    const double per_tick = static_cast<double>(state.range(0)) / 3;
+    const SpawnRate rates[] = {{OrcType, per_tick}, {KnightType, per_tick}, {BearType, per_tick}};
+    SpawnStage stage(1, rates);
+    auto world = std::make_unique<World>(2000, 2000);
+    auto grid = std::make_unique<SpatialGrid>(2000, 2000, DEFAULT_KILL_DISTANCE);
+    size_t tick = 0, born = 0;
+    for (auto _ : state) {
+        if (world->size() >= 1000000) {
+            state.PauseTiming();
+            world = std::make_unique<World>(2000, 2000);
+            grid = std::make_unique<SpatialGrid>(2000, 2000, DEFAULT_KILL_DISTANCE);
+            state.ResumeTiming();
+        }
+        born += stage.run(*world, *grid, tick++);
+    }
+    state.SetItemsProcessed(born);
+}
+
+// Вся симуляция в установившемся режиме: рождения уравновешены боями
+// и пределом численности, мёртвых хоронит compact
+void BM_SimulationSpawning(benchmark::State &state) {
+    SimulationConfig config;
+    config.seed = 7;
+    config.population = {0, 0, 0};
+    config.max_x = config.max_y = 2000;
+    const double per_tick = static_cast<double>(state.range(0)) / 3;
+    config.spawn_rates = {{OrcType, per_tick}, {KnightType, per_tick}, {BearType, per_tick}};
+    config.population_cap = 20000;
+    Simulation sim(config);
+    TickScheduler scheduler(0.0);
+    sim.attach(scheduler);
+    scheduler.run(50); // выход на установившийся режим
+    size_t before = sim.get_world().population().total_alive() + sim.get_world().dead_count();
+    for (auto _ : state)
+        scheduler.run(1);
+    size_t after = sim.get_world().population().total_alive() + sim.get_world().dead_count();
+    state.SetItemsProcessed(after - before);
+    state.counters["alive"] = static_cast<double>(sim.get_world().population().total_alive());
+}
+
+}
+
+BENCHMARK(BM_SpawnStage)->Arg(300)->Arg(3000);
+BENCHMARK(BM_SimulationSpawning)->Arg(300)->Arg(3000);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Асинхронный журнал. Производители дописывают готовые записи в буфер
+// своего потока (его мьютекс берёт только писатель на время swap),
+// фоновый поток собирает буферы и пишет их одним write на пачку.
+// Диск никогда не блокирует производителя; деструктор дописывает всё.
+class AsyncLogger {
+public:
+    explicit AsyncLogger(const std::string &path, bool append = false,
+                         std::chrono::milliseconds flush_interval = std::chrono::milliseconds(50),
+                         size_t flush_bytes = 64 * 1024);
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    void log(std::string_view record);
+
+    // Дожидается, пока всё записанное до вызова окажется в файле
+    void flush();
+
+    bool is_open() const { return fd >= 0; }
+    size_t bytes_written() const { return written; }
+    size_t write_calls() const { return writes; }
+    // Буферов в кэше вызывающего потока (включая ещё не вычищенные
+    // буферы удалённых журналов)
+    static size_t thread_cache_size();
+
+private:
+    struct ThreadBuffer {
+        std::mutex mtx;
+        std::string data;
+    };
+
+    ThreadBuffer &local_buffer();
+    void writer_loop();
+    // Возвращает true, если что-то было записано
+    bool write_pending(std::string &batch);
+
+    struct CacheEntry {
+        std::uint64_t logger;
+        std::weak_ptr<const std::uint64_t> owner; // истёк - журнала больше нет
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    static std::vector<CacheEntry> &thread_cache();
+
+    int fd{-1};
+    std::uint64_t id;
+    std::shared_ptr<const std::uint64_t> token; // держит owner записей кэша
+    std::chrono::milliseconds interval;
+    size_t threshold;
+
+    std::mutex registry_mtx;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    std::mutex writer_mtx;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    bool stopping{false};
+    bool urgent{false};
+    std::uint64_t flush_requested{0};
+    std::uint64_t flush_done{0};
+
+    std::atomic<size_t> written{0};
+    std::atomic<size_t> writes{0};
+    std::thread writer;
+};
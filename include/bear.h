@@ -5,6 +5,7 @@ class Bear : public NPC {
 public:
     Bear(int x, int y, const std::string& name = "");
     Bear(std::istream &is);
+    Bear(World &world, EntityId id);
 
     void print() override;
     void print(std::ostream &os) override;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "world.h"
+#include "simulation.h"
+
+struct ChunkConfig {
+    int chunk_size{256};             // сторона чанка в единицах карты
+    size_t memory_budget{64u << 20}; // байт на столбцы резидентных чанков
+    std::string page_dir;            // файлы выгруженных чанков; пусто - временный каталог
+};
+
+struct ChunkStats {
+    size_t resident{0};       // чанков в памяти
+    size_t paged{0};          // чанков на диске
+    size_t resident_bytes{0}; // World::memory_bytes() резидентных
+    size_t page_ins{0};
+    size_t page_outs{0};
+};
+
+// Мир, разбитый на чанки chunk_size x chunk_size. Чанк хранит своих NPC
+// отдельной Simulation (World и сетка соседей над чанком) и существует,
+// только пока в нём кто-то есть, поэтому пустые области карты памяти не
+// занимают. Такт: ходы во всех резидентных чанках, переход вышедших за
+// границу к соседям, бои внутри чанков, затем бои через границы
+// резидентных соседей (как проход по границам в RegionFightResolver),
+// похороны.
+//
+// Когда резидентные чанки не укладываются в memory_budget, давно не
+// использованные (LRU) выгружаются в page_dir в формате снимка
+// (snapshot.h). Выгруженный чанк замирает вместе со своими NPC: они не
+// ходят и не дерутся, в том числе с соседями через границу, поэтому итог
+// игры зависит от бюджета. Без выгрузки (бюджет не превышен) чанковый мир
+// играет по тем же правилам, что и целый. Использование - рождение, вход
+// NPC из соседа и touch(); ходы внутри чанка им не считаются, так что
+// тихие области уходят на диск первыми. Выгруженный чанк загружается
+// обратно, когда в него входит NPC или его трогают touch(). Чанки,
+// использованные текущей операцией, не выгружаются, даже если бюджет
+// превышен.
+//
+// Не потокобезопасен: все вызовы - из потока симуляции.
+class ChunkedWorld {
+public:
+    // Карта, seed, шаги и радиус боя - из config; население не расселяется,
+    // пока не вызван populate(). Рождения и поток боёв в чанках не ведутся
+    explicit ChunkedWorld(const SimulationConfig &config, ChunkConfig chunks = {});
+    // Удаляет файлы выгруженных чанков
+    ~ChunkedWorld();
+
+    ChunkedWorld(const ChunkedWorld&) = delete;
+    ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+    int max_x() const { return width; }
+    int max_y() const { return height; }
+    int chunk_size() const { return cfg.chunk_size; }
+    // Новый бюджет действует со следующей операции
+    void set_memory_budget(size_t bytes) { cfg.memory_budget = bytes; }
+
+    // Расселяет config.population так же, как Simulation
+    void populate();
+    // false - чанк не удалось загрузить (причина в std::cerr)
+    bool spawn(NpcType type, int x, int y, std::string_view name = {});
+    // Загружает и держит резидентными существующие чанки
+    // в radius чанков вокруг точки
+    void touch(int x, int y, int radius = 0);
+    // Такт резидентных чанков (ходы, бои, похороны), переход через
+    // границы чанков, выгрузка по бюджету
+    void tick(size_t tick);
+
+    // Чанк точки, если он в памяти; иначе nullptr
+    const World *resident_chunk(int x, int y) const;
+    bool is_paged(int x, int y) const;
+    // Живые во всех чанках, в том числе выгруженных
+    size_t population() const;
+    // По фракциям; dead - все погибшие с начала игры
+    PopulationCounts counts() const;
+    ChunkStats stats() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<Simulation> sim; // nullptr - выгружен
+        PopulationCounts paged;          // живые на момент выгрузки
+        std::uint64_t used{0};        // номер последней использовавшей операции
+        size_t bytes{0};              // учтено в resident_bytes
+        std::list<std::uint64_t>::iterator lru; // действителен, пока sim != nullptr
+    };
+
+    struct Migrant {
+        std::uint64_t from;
+        std::uint64_t to;
+        NpcType type;
+        int x, y;
+        std::string name;
+    };
+
+    std::uint64_t key_of(int x, int y) const;
+    MapArea area_of(std::uint64_t key) const;
+    // keys - резидентные чанки по возрастанию ключа
+    void resident_keys();
+    // Бои пар из соседних резидентных чанков, после боёв внутри чанков
+    void border_fights();
+    std::string path_of(std::uint64_t key) const;
+    std::unique_ptr<Simulation> make_chunk(std::uint64_t key, std::unique_ptr<World> world) const;
+    // Чанк в памяти (с загрузкой или созданием, если create); метит использование
+    Simulation *use(std::uint64_t key, bool create);
+    // Погибшие чанка уходят в retired_dead: чанк выгружается или удаляется
+    void retire(Chunk &chunk);
+    bool page_out(std::uint64_t key, Chunk &chunk);
+    // Переучитывает memory_bytes() резидентного чанка
+    void account(Chunk &chunk);
+    void enforce_budget();
+    void drop_empty();
+
+    int width;
+    int height;
+    SimulationConfig sim_cfg; // карта и население; чанку - make_chunk
+    ChunkConfig cfg;
+    bool own_dir{false};
+    std::unordered_map<std::uint64_t, Chunk> chunks;
+    std::list<std::uint64_t> lru; // голова - последний использованный
+    std::uint64_t epoch{0};
+    size_t resident_bytes{0};
+    size_t page_ins{0};
+    size_t page_outs{0};
+    size_t retired_dead{0}; // погибшие в выгруженных и удалённых чанках
+
+    // Буферы такта
+    std::vector<std::uint64_t> keys;
+    std::vector<Migrant> migrants;
+    std::vector<EntityId> halo_here;
+    std::vector<EntityId> halo_there;
+};
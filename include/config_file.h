@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include "simulation.h"
+
+// Параметры игры, которые можно менять без пересборки
+struct GameConfig {
+    SimulationConfig sim;
+    int render_grid{20}; // клеток кадра по каждой оси
+};
+
+// Файл конфигурации: строки "ключ = значение", # - комментарий до конца строки.
+//   map = 800x600           размер карты (или одно число для квадратной)
+//   kill_distance = 10      радиус боя, он же клетка пространственной сетки
+//   render_grid = 20        сетка кадра
+//   move.orc = 20           шаг движения типа по имени из npc_registry()
+//   ticks = 30
+//   orcs = 5                состав армий; также knights, bears
+//   spawn.elf = 40          число NPC любого зарегистрированного типа
+//   rate.orc = 0.5          рождений типа за такт по ходу игры (spawn_stage.h)
+//   population_cap = 10000  предел живых для рождений, 0 - без предела
+// Незаданные ключи не меняются, поэтому флаги после --config перекрывают файл.
+// При ошибке пишет причину в std::cerr (origin:строка) и возвращает false;
+// config тогда может быть изменён частично.
+bool parse_config(std::istream &is, GameConfig &config, const std::string &origin = "config");
+bool load_config(const std::string &path, GameConfig &config);
+
+// "500" - квадратная карта, "800x600" - ширина и высота
+bool parse_map_size(const std::string &arg, int &max_x, int &max_y);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+#include "world.h"
+
+// Компактная запись о бое: только id и типы, без shared_ptr
+struct FightRecord {
+    EntityId attacker;
+    EntityId defender;
+    std::uint8_t attacker_type;
+    std::uint8_t defender_type;
+    bool win;
+};
+
+// На какие бои подписан наблюдатель
+enum class FightFilter {
+    All,
+    WinsOnly
+};
+
+class IFightBatchObserver {
+public:
+    virtual ~IFightBatchObserver() = default;
+    virtual void on_fights(const World &world, std::span<const FightRecord> fights) = 0;
+};
+
+// Шина событий мира. Наблюдатели подписываются один раз на весь мир,
+// бои копятся и раздаются пачкой в dispatch. Фильтр применяется
+// один раз на пачку до вызова наблюдателей.
+class EventBus {
+public:
+    void subscribe(std::shared_ptr<IFightBatchObserver> observer, FightFilter filter = FightFilter::All);
+
+    void publish(const FightRecord &record);
+
+    // Раздаёт накопленное и очищает очередь; возвращает число боёв в пачке
+    size_t dispatch(const World &world);
+
+    size_t pending() const;
+
+private:
+    std::vector<std::shared_ptr<IFightBatchObserver>> all_observers;
+    std::vector<std::shared_ptr<IFightBatchObserver>> win_observers;
+
+    mutable std::mutex mtx;
+    std::vector<FightRecord> records;
+    std::vector<FightRecord> batch;
+    std::vector<FightRecord> wins;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Eventcount поверх std::atomic::wait (на Linux - futex).
+// Потребитель: key = prepare_wait(); перепроверить условие;
+// если оно выполнено - cancel_wait(), иначе wait(key).
+// Производитель: изменить состояние, затем notify().
+class EventCount {
+public:
+    using key_t = std::uint32_t;
+
+    key_t prepare_wait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    void cancel_wait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wait(key_t key) {
+        epoch.wait(key, std::memory_order_acquire);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Без ожидающих стоит одну загрузку, системный вызов не делается
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) != 0)
+            notify_all();
+    }
+
+    void notify_all() {
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_all();
+    }
+
+private:
+    std::atomic<std::uint32_t> epoch{0};
+    std::atomic<std::uint32_t> waiters{0};
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include "npc.h"
+#include "world.h"
+
+//фабрика из файла (текстовый формат NPC::save)
+std::shared_ptr<NPC> factory(std::istream &is);
+
+//фабрика view на сущность, уже существующую в мире
+std::shared_ptr<NPC> factory(World &world, EntityId id);
+
+//фабрика из параметров: состояние NPC создаётся в мире, объект - его view
+std::shared_ptr<NPC> factory(World &world, NpcType type, int x, int y);
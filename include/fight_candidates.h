@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "world.h"
+#include "region_fights.h"
+
+// Каноническая пара боя: одна на неупорядоченную пару {a, b}.
+// Атакует тот, кто по матрице npc_registry() убивает другого; если побеждают
+// оба или никто - меньший id. Исход совпадает с разбором {a, b} и {b, a}
+// подряд: второе событие после убийства всё равно отбрасывается.
+FightPair canonical_fight(const World &world, EntityId a, EntityId b);
+
+// Множество пар, которые уже стоят в очереди боёв. Пара - две ссылки с
+// поколениями: если слот освободили и заняли снова, новый NPC - другая пара,
+// и дублем старой она не считается. Ёмкость задаётся при
+// создании и не растёт: при заполнении insert отказывает, и пара просто
+// найдётся снова на следующем такте. Таблица с открытой адресацией,
+// разбитая на SHARDS частей со своими мьютексами, чтобы производители
+// разных пар не толкались на одной блокировке.
+class InFlightPairs {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    explicit InFlightPairs(size_t capacity);
+
+    InFlightPairs(const InFlightPairs&) = delete;
+    InFlightPairs& operator=(const InFlightPairs&) = delete;
+
+    enum class Insert {
+        Added,
+        Duplicate, // пара {a, b} или {b, a} уже в полёте
+        Full
+    };
+
+    // Порядок a и b не важен
+    Insert insert(EntityHandle a, EntityHandle b);
+    void erase(EntityHandle a, EntityHandle b);
+
+    size_t size() const;
+    size_t capacity() const { return SHARDS * shard_capacity; }
+
+private:
+    // Ссылки упакованы как (generation << 32) | id, первой идёт меньший id
+    struct Key {
+        std::uint64_t first{0}; // 0 - пустой слот
+        std::uint64_t second{0};
+
+        bool operator==(const Key &) const = default;
+    };
+
+    struct Shard {
+        mutable std::mutex mtx;
+        std::unique_ptr<Key[]> slots;
+        size_t used{0};
+    };
+
+    static Key key_of(EntityHandle a, EntityHandle b);
+    static std::uint64_t hash(const Key &key);
+
+    size_t shard_capacity;            // слотов в части, степень двойки
+    size_t shard_limit;               // не больше половины слотов заняты
+    std::array<Shard, SHARDS> shards;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <vector>
+#include "npc.h"
+#include "mpsc_queue.h"
+#include "event_count.h"
+#include "region_fights.h"
+#include "event_bus.h"
+#include "fight_candidates.h"
+
+// Событие боя - две ссылки на слоты мира, без shared_ptr и атомарных
+// счётчиков ссылок. Если слот успели освободить и занять снова, поколение
+// не совпадёт и событие пропускается.
+struct FightEvent {
+    EntityHandle attacker;
+    EntityHandle defender;
+    bool candidate{false}; // поставлено add_candidate и числится в in_flight
+};
+
+// Эталонный путь через двойную диспетчеризацию accept -> fight
+bool resolve_with_visitor(const std::shared_ptr<NPC> &attacker, const std::shared_ptr<NPC> &defender);
+
+// Быстрый путь через матрицу боёв npc_registry() для отдельных NPC
+bool resolve_with_table(const std::shared_ptr<NPC> &attacker, const std::shared_ptr<NPC> &defender);
+
+// Разбор события в мире по таблице; вызывающий держит World::mutex() эксклюзивно.
+// Исход уходит на шину, если она задана.
+bool resolve_in_world(World &world, const FightEvent &event, EventBus *bus);
+
+// События кладут любые потоки, разбирает один поток бойни.
+// Пока очередь пуста, поток спит на eventcount и просыпается сразу по add_event.
+// Менеджер принадлежит одному миру: общих для процесса экземпляров нет.
+class FightManager {
+private:
+    static constexpr size_t QUEUE_CAPACITY = 1 << 16;
+
+    World &world;
+    MpscQueue<FightEvent> events{QUEUE_CAPACITY};
+    EventCount ready;
+    std::atomic<bool> running{true};
+    std::unique_ptr<RegionFightResolver> resolver;
+    EventBus *bus{nullptr};
+    // Пары из add_candidate, которые ещё не разобраны; не больше очереди
+    InFlightPairs in_flight{QUEUE_CAPACITY};
+
+    size_t pop_batch(std::vector<FightEvent> &batch);
+    // Разбор вынутой из очереди пачки; после него пары кандидатов снова
+    // можно ставить
+    size_t finish_batch(std::span<FightEvent> batch);
+    size_t resolve_parallel(std::span<FightEvent> batch);
+
+public:
+    explicit FightManager(World &w) : world(w) {}
+
+    FightManager(const FightManager&) = delete;
+    FightManager& operator=(const FightManager&) = delete;
+
+    // При заполненной очереди ждёт, пока потребитель освободит место.
+    // Событие идёт как есть, мимо проверки дублей.
+    void add_event(FightEvent &&event);
+    // Кандидат от поиска соседей: ставится canonical_fight(a, b), если эта
+    // пара ещё не в полёте. Не ждёт: при полной очереди или таблице пар
+    // возвращает false, и пара найдётся снова на следующем такте.
+    // Вызывающий держит World::mutex() хотя бы на чтение.
+    bool add_candidate(EntityId a, EntityId b);
+    size_t in_flight_pairs() const { return in_flight.size(); }
+
+    World &get_world() { return world; }
+
+    // Параллельный разбор по регионам; workers <= 1 возвращает последовательный
+    void set_parallel(size_t workers);
+
+    // Исходы боёв уходят на шину
+    void set_event_bus(EventBus *event_bus) { bus = event_bus; }
+
+    // Разбирает пачку событий по таблице; возвращает число убитых
+    size_t resolve_batch(std::span<FightEvent> batch);
+    // Синхронно разбирает всё, что накопилось в очереди
+    size_t drain();
+
+    void stop();
+
+    void operator()();
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "npc.h"
+
+// Исход боя зависит только от пары типов (атакующий, защитник), поэтому
+// вместо двойной диспетчеризации accept -> fight достаточно таблицы.
+// win[attacker][defender] == true - атакующий убивает защитника.
+template <size_t N>
+using WinMatrix = std::array<std::array<bool, N>, N>;
+
+constexpr WinMatrix<NPC_TYPE_COUNT> make_fight_table() {
+    WinMatrix<NPC_TYPE_COUNT> win{};
+    win[KnightType][OrcType] = true; // рыцарь убивает орка
+    win[OrcType][BearType] = true;   // орк убивает медведя
+    win[BearType][KnightType] = true; // медведь убивает рыцаря
+    return win;
+}
+
+inline constexpr WinMatrix<NPC_TYPE_COUNT> fight_table = make_fight_table();
+
+template <size_t N>
+constexpr bool resolve_fight(const WinMatrix<N> &win, size_t attacker, size_t defender) {
+    return attacker < N && defender < N && win[attacker][defender];
+}
+
+constexpr bool resolve_fight(NpcType attacker, NpcType defender) {
+    return resolve_fight(fight_table, static_cast<size_t>(attacker), static_cast<size_t>(defender));
+}
+
+static_assert(resolve_fight(KnightType, OrcType) && !resolve_fight(OrcType, KnightType));
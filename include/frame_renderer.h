@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "world.h"
+
+class AsyncLogger;
+
+// Клетка карты: символ и до трёх первых букв имени
+struct RenderCell {
+    char glyph;          // 0 - пусто, буква типа из реестра, X - мёртвый
+    std::uint8_t name_len;
+    char name[3];
+};
+
+// Снимок карты на конец такта; память выделяется один раз
+struct RenderFrame {
+    size_t tick{0};
+    size_t total{0};
+    PopulationCounts stats;
+    std::vector<RenderCell> cells;
+};
+
+// Отрисовка карты вне потока симуляции. capture() копирует позиции в
+// заранее выделенный кадр и отдаёт его фоновому потоку; тот форматирует
+// кадр в один непрерывный буфер и пишет его одним write. Кадры меняются
+// местами под коротким мьютексом, поэтому симуляция терминал не ждёт:
+// если писатель не успел, неотрисованный кадр заменяется свежим.
+class FrameRenderer {
+public:
+    // console - мьютекс вывода игры, берётся только на время write;
+    // log - куда дублировать кадр в текстовом виде (может быть nullptr)
+    FrameRenderer(int grid, int fd, std::mutex &console, AsyncLogger *log = nullptr);
+    ~FrameRenderer();
+
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    // Вызывается из потока симуляции, пока мир не меняется
+    void capture(const World &world, size_t tick);
+
+    // Дожидается, пока последний отданный кадр будет выведен
+    void flush();
+
+    size_t frames_written() const;
+    size_t frames_dropped() const;
+    size_t write_calls() const;
+
+    // Текст кадра для консоли и для журнала; out дописывается
+    static void format_console(const RenderFrame &frame, int grid, std::string &out);
+    static void format_log(const RenderFrame &frame, int grid, std::string &out);
+
+private:
+    void writer_loop();
+    size_t write_all(const std::string &text);
+
+    int grid;
+    int fd;
+    std::mutex &console_mutex;
+    AsyncLogger *log;
+
+    RenderFrame back;   // заполняет поток симуляции
+    RenderFrame ready;  // ждёт писателя
+    RenderFrame front;  // форматирует писатель
+    std::string text;
+    std::string log_text;
+
+    mutable std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable drawn;
+    bool has_ready{false};
+    bool drawing{false};
+    bool stopping{false};
+    size_t written{0};
+    size_t dropped{0};
+    size_t writes{0};
+    std::thread writer;
+};
@@ -6,6 +6,7 @@ class Knight : public NPC
 public:
     Knight(int x, int y, const std::string& name = "");
     Knight(std::istream &is);
+    Knight(World &world, EntityId id);
 
     void print() override;
     void print(std::ostream &os) override;
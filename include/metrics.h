@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Счётчики горячих путей и гистограммы задержек по фазам.
+// Запись - relaxed-инкременты атомиков, без блокировок и выделений.
+// Макросы LAB7_COUNT / LAB7_TIME исчезают при сборке без LAB7_METRICS
+// (cmake -DLAB7_METRICS=OFF); сам класс Metrics и экспорт остаются.
+
+enum class MetricCounter {
+    FightsEnqueued = 0, // события боя, поставленные в очередь или пачку такта
+    FightsResolved,     // разобранные: оба участника были живы
+    FightsSkippedDead,  // отброшенные: участник мёртв или ссылка устарела
+    FightsRequeued,     // события add_event, ждавшие места в полной очереди
+    FightsDeduplicated, // кандидаты, чья пара уже в полёте
+    FightsDropped,      // кандидаты, не поместившиеся в очередь или таблицу пар
+    NpcsBuried,         // мёртвые, убранные compact() на кладбище
+    NpcsSpawned,        // рождённые SpawnStage по ходу игры
+    ChunksPagedIn,      // чанки ChunkedWorld, загруженные с диска
+    ChunksPagedOut,     // чанки, выгруженные по бюджету памяти
+    Count
+};
+
+// Первые семь совпадают с TickPhase
+enum class MetricTimer {
+    Move = 0,
+    Detect,
+    Fight,
+    Observe,
+    Render,
+    Compact,
+    Spawn,
+    FightBatch, // FightManager::resolve_batch
+    FrameWrite, // форматирование и запись кадра фоновым потоком
+    PageIn,     // загрузка чанка ChunkedWorld с диска
+    PageOut,    // выгрузка чанка на диск
+    Count
+};
+
+const char *metric_name(MetricCounter counter);
+const char *metric_name(MetricTimer timer);
+
+// Лог-линейная гистограмма наносекунд: до 16 - точные значения, дальше
+// 8 корзин на каждую степень двойки (погрешность квантиля до 12.5%).
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 16 + 60 * 8;
+
+    void record(std::uint64_t ns);
+    void reset();
+
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::uint64_t sum() const { return sum_ns.load(std::memory_order_relaxed); }
+    std::uint64_t max() const { return max_ns.load(std::memory_order_relaxed); }
+    // Верхняя граница корзины, в которую попал квантиль q (0..1); 0 без записей
+    std::uint64_t percentile(double q) const;
+
+    static size_t bucket_of(std::uint64_t ns);
+    static std::uint64_t bucket_upper(size_t bucket);
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets{};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> sum_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+};
+
+class Metrics {
+public:
+    void add(MetricCounter counter, std::uint64_t n = 1) {
+        counters[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+    std::uint64_t get(MetricCounter counter) const {
+        return counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    LatencyHistogram &histogram(MetricTimer timer) { return timers[static_cast<size_t>(timer)]; }
+    const LatencyHistogram &histogram(MetricTimer timer) const { return timers[static_cast<size_t>(timer)]; }
+
+    void reset();
+
+    // Снимок на момент вызова; можно звать во время работы
+    void export_json(std::ostream &os) const;
+    void export_prometheus(std::ostream &os) const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, static_cast<size_t>(MetricCounter::Count)> counters{};
+    std::array<LatencyHistogram, static_cast<size_t>(MetricTimer::Count)> timers;
+};
+
+// Общие метрики процесса
+Metrics &metrics();
+
+// Время от конструктора до деструктора уходит в гистограмму
+class ScopedTimer {
+public:
+    explicit ScopedTimer(MetricTimer t) : timer(t), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        metrics().histogram(timer).record(static_cast<std::uint64_t>(ns.count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    MetricTimer timer;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define LAB7_METRICS_CAT2(a, b) a##b
+#define LAB7_METRICS_CAT(a, b) LAB7_METRICS_CAT2(a, b)
+
+#ifdef LAB7_METRICS
+#define LAB7_COUNT(counter, n) metrics().add(MetricCounter::counter, (n))
+#define LAB7_TIME(timer) ScopedTimer LAB7_METRICS_CAT(lab7_timer_, __LINE__)(timer)
+#else
+#define LAB7_COUNT(counter, n) ((void)0)
+#define LAB7_TIME(timer) ((void)0)
+#endif
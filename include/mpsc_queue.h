@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Ограниченная lock-free очередь: много производителей, один потребитель.
+// Кольцевой буфер с номером последовательности в каждой ячейке
+// (схема Д. Вьюкова). Ёмкость округляется вверх до степени двойки.
+template <typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity);
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // false - очередь заполнена, value не тронут
+    bool try_push(T &&value);
+    // Вызывать только из потока-потребителя
+    bool try_pop(T &value);
+
+    size_t capacity() const { return mask + 1; }
+    bool empty() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t n);
+
+    size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) size_t head{0};
+};
+
+template <typename T>
+size_t MpscQueue<T>::round_up(size_t n) {
+    size_t result = 2;
+    while (result < n)
+        result <<= 1;
+    return result;
+}
+
+template <typename T>
+MpscQueue<T>::MpscQueue(size_t capacity)
+    : mask(round_up(capacity) - 1), cells(new Cell[mask + 1]) {
+    for (size_t i = 0; i <= mask; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool MpscQueue<T>::try_push(T &&value) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = cells[pos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool MpscQueue<T>::try_pop(T &value) {
+    Cell &cell = cells[head & mask];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if (seq != head + 1)
+        return false;
+    value = std::move(cell.value);
+    cell.value = T{};
+    cell.sequence.store(head + mask + 1, std::memory_order_release);
+    ++head;
+    return true;
+}
+
+template <typename T>
+bool MpscQueue<T>::empty() const {
+    return cells[head & mask].sequence.load(std::memory_order_acquire) != head + 1;
+}
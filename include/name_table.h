@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Таблица интернированных строк: одинаковые имена хранятся один раз,
+// сущность держит 32-битный id. Строки лежат в блоках, которые никогда
+// не перемещаются (блок k вмещает 16 << k строк), поэтому view(id)
+// возвращает string_view без блокировок и выделений, а string_view
+// остаётся действительным, пока жива таблица.
+// intern() пишет под мьютексом и может идти параллельно с view().
+class NameTable {
+public:
+    NameTable() = default;
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    std::uint32_t intern(std::string_view name);
+    std::string_view view(std::uint32_t id) const { return slot(id); }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Заменяет содержимое: id i получает names[i]. Не параллельно с чтением.
+    void assign(std::span<const std::string_view> names);
+
+private:
+    static constexpr unsigned FIRST_BITS = 4; // 16 строк в блоке 0
+    static constexpr size_t BLOCKS = 28;
+
+    static unsigned block_of(std::uint32_t id, size_t &offset);
+    const std::string &slot(std::uint32_t id) const;
+    void push(std::string_view name);
+
+    std::array<std::unique_ptr<std::string[]>, BLOCKS> blocks;
+    std::atomic<size_t> count{0};
+
+    std::mutex mtx;
+    std::unordered_map<std::string_view, std::uint32_t> index;
+};
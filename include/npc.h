@@ -4,6 +4,7 @@
 #include <memory>
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <random>
 #include <fstream>
 #include <set>
@@ -11,14 +12,20 @@
 #include <shared_mutex>
 #include <mutex>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include "name_table.h"
 
 class NPC;
 class IFightObserver;
 class Orc;
 class Knight;
 class Bear;
+class World;
 
 using set_t = std::set<std::shared_ptr<NPC>>;
+using EntityId = std::uint32_t;
 
 enum NpcType
 {
@@ -28,6 +35,26 @@ enum NpcType
     BearType = 3
 };
 
+constexpr size_t NPC_TYPE_COUNT = 4; // встроенные: Unknown, Orc, Knight, Bear
+// Предел реестра типов (npc_registry.h), включая встроенные
+constexpr size_t MAX_NPC_TYPES = 64;
+
+// Шаг движения по типам, индекс - NpcType. Значения по умолчанию берутся
+// из реестра и меняются файлом конфигурации (см. config_file.h)
+using MoveRanges = std::vector<int>;
+constexpr std::array<int, NPC_TYPE_COUNT> DEFAULT_MOVE_RANGES{0, 20, 30, 5};
+constexpr int DEFAULT_KILL_DISTANCE = 10;
+
+// Описания типов берутся из npc_registry()
+std::string generate_random_name(NpcType type);
+// Список имён, из которого выбирает generate_random_name
+const std::vector<std::string> &name_pool(NpcType type);
+// Общая таблица имён NPC, не привязанных к миру (заранее содержит все списки)
+NameTable &npc_names();
+const char *type_name(NpcType type);
+// Шаг по умолчанию из реестра; у неизвестных типов 0
+int move_distance(NpcType type);
+
 class IFightObserver {
 public:
     virtual void on_fight(const std::shared_ptr<NPC> attacker, const std::shared_ptr<NPC> defender, bool win) = 0;
@@ -35,17 +62,26 @@ public:
 
 class NPC : public std::enable_shared_from_this<NPC> {
 private: 
-    mutable std::mutex mtx;  // Добавили mutable
-    NpcType type;
-    int x{0};
-    int y{0};
-    bool alive{true};
-    std::string name;
+    // Тип и имя не меняются после конструктора, поэтому читаются без блокировок.
+    // Имя - id в npc_names(); у привязанного к миру NPC не используется:
+    // имя читается из столбца мира, ведь слот могли освободить и занять снова.
+    // Позиция и флаг жизни упакованы в одно атомарное слово:
+    // биты 0-30 - x, 31-61 - y (знаковые 31 бит), 63 - alive.
+    const NpcType type;
+    std::atomic<std::uint64_t> state{0};
+    std::uint32_t name_id{0};
     std::vector<std::shared_ptr<IFightObserver>> observers;
+    // Если NPC привязан к миру, состояние живёт в World, а объект - только view
+    World *world{nullptr};
+    EntityId id{0};
 
 public:
     NPC(NpcType t, int _x, int _y, const std::string& _name = "");
     NPC(NpcType t, std::istream &is);
+    NPC(NpcType t, World &w, EntityId _id);
+
+    World *bound_world() const { return world; }
+    EntityId entity() const { return id; }
 
     void subscribe(std::shared_ptr<IFightObserver> observer);
     void fight_notify(const std::shared_ptr<NPC> defender, bool win);
@@ -61,8 +97,8 @@ public:
     bool visit(std::shared_ptr<Bear> other);
 
     std::pair<int, int> position();
-    NpcType get_type();
-    std::string get_name() const;  // const метод
+    NpcType get_type() const { return type; }
+    std::string_view get_name() const;
     
     virtual void print() = 0;
     virtual void print(std::ostream &os) = 0;
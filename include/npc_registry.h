@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.h"
+
+// Всё, что симуляции нужно знать о фракции
+struct NpcTypeInfo {
+    std::string name;               // "Orc": печать и ключи конфигурации (move.orc)
+    char glyph{0};                  // буква в кадре; 'X' занята мёртвыми
+    int move_range{0};              // шаг по умолчанию
+    std::vector<std::string> names; // имена для расселения
+};
+
+// Реестр типов NPC. Встроенные Unknown/Orc/Knight/Bear есть с самого начала;
+// новая фракция - вызов add() и её строки в матрице боёв, без новых классов
+// и виртуальных методов. Тип - индекс в реестре, он же байт в столбце types
+// мира. Исход боя берётся из плотной матрицы MAX_NPC_TYPES x MAX_NPC_TYPES,
+// поэтому wins() - одно чтение при любом числе типов.
+//
+// Регистрировать до запуска симуляции: чтение идёт без блокировок.
+// Классы Orc/Knight/Bear (и factory) есть только у встроенных типов,
+// новые фракции живут в мире (World) как строки столбцов.
+class NpcRegistry {
+public:
+    NpcRegistry();
+
+    NpcRegistry(const NpcRegistry&) = delete;
+    NpcRegistry& operator=(const NpcRegistry&) = delete;
+
+    // Новый тип. Если имя занято или реестр полон, пишет причину
+    // в std::cerr и возвращает Unknown.
+    NpcType add(NpcTypeInfo info);
+    void set_wins(NpcType attacker, NpcType defender, bool win = true);
+    // Откат: забывает типы с индексами от count и их строки матрицы.
+    // Встроенные типы не трогает. Как и add(), только до запуска симуляции.
+    void truncate(size_t count);
+
+    bool wins(std::uint8_t attacker, std::uint8_t defender) const {
+        return attacker < MAX_NPC_TYPES && defender < MAX_NPC_TYPES
+            && matrix[attacker * MAX_NPC_TYPES + defender];
+    }
+    char glyph(std::uint8_t type) const { return type < MAX_NPC_TYPES ? glyphs[type] : 0; }
+
+    size_t size() const { return types.size(); }
+    // Для незарегистрированных типов - описание Unknown
+    const NpcTypeInfo &info(NpcType type) const;
+    // Поиск по имени без учёта регистра; Unknown, если такого нет
+    NpcType find(std::string_view name) const;
+    // Шаги по умолчанию всех зарегистрированных типов, индекс - NpcType
+    MoveRanges move_ranges() const;
+
+private:
+    std::vector<NpcTypeInfo> types;
+    std::array<char, MAX_NPC_TYPES> glyphs{};
+    std::array<std::uint8_t, MAX_NPC_TYPES * MAX_NPC_TYPES> matrix{};
+};
+
+// Общий реестр процесса
+NpcRegistry &npc_registry();
@@ -5,6 +5,7 @@ class Orc : public NPC {
 public:
     Orc(int x, int y, const std::string& name = "");
     Orc(std::istream &is);
+    Orc(World &world, EntityId id);
 
     void print() override;
     void print(std::ostream &os) override;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "world.h"
+
+// Численность на конец такта; 24 байта на запись
+struct PopulationSample {
+    std::uint32_t tick;
+    std::uint32_t dead;
+    std::array<std::uint32_t, NPC_TYPE_COUNT> alive; // встроенные типы, индекс - NpcType
+};
+
+// Кольцевой буфер последних capacity тактов: память выделяется один раз,
+// старые записи затираются новыми.
+class PopulationHistory {
+public:
+    explicit PopulationHistory(size_t capacity = 4096);
+
+    void record(size_t tick, const PopulationCounts &counts);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return buffer.size(); }
+    // i = 0 - самая старая из хранящихся записей
+    const PopulationSample &operator[](size_t i) const;
+    const PopulationSample &back() const { return (*this)[count - 1]; }
+
+    // CSV: tick,orcs,knights,bears,dead - от старых к новым
+    void export_csv(std::ostream &os) const;
+
+private:
+    std::vector<PopulationSample> buffer;
+    size_t head{0}; // куда пишется следующая запись
+    size_t count{0};
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+#include "world.h"
+
+struct FightPair {
+    EntityId attacker;
+    EntityId defender;
+};
+
+struct FightOutcome {
+    size_t event; // индекс пары во входной пачке
+    bool win;
+};
+
+// Параллельный разбор боёв. Карта делится на вертикальные полосы-регионы,
+// каждой владеет свой поток. Бой, оба участника которого в одном регионе,
+// разбирает владелец без блокировок: он пишет alive только своих сущностей.
+// Пограничные бои разбираются после всех регионов в одном потоке
+// в порядке (attacker, defender), поэтому результат детерминирован.
+class RegionFightResolver {
+public:
+    RegionFightResolver(World &world, size_t workers);
+    ~RegionFightResolver();
+
+    RegionFightResolver(const RegionFightResolver&) = delete;
+    RegionFightResolver& operator=(const RegionFightResolver&) = delete;
+
+    World &get_world() { return world; }
+    size_t workers() const { return regions.size(); }
+    size_t region_of(int x) const;
+
+    // Вызывающий держит World::mutex() эксклюзивно на время разбора.
+    // Исходы: регионы по порядку (внутри - в порядке пачки), затем граница.
+    std::vector<FightOutcome> resolve(std::span<const FightPair> fights);
+
+private:
+    struct Region {
+        std::vector<size_t> events;
+        std::vector<FightOutcome> outcomes;
+    };
+
+    void resolve_region(Region &region);
+    bool resolve_one(size_t event, std::vector<FightOutcome> &outcomes);
+    void worker_loop(size_t index);
+
+    World &world;
+    std::span<const FightPair> batch;
+    std::vector<Region> regions;
+    std::vector<size_t> border;
+
+    std::vector<std::thread> threads;
+    std::atomic<std::uint32_t> generation{0};
+    std::atomic<std::uint32_t> pending{0};
+    std::atomic<bool> running{true};
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Счётчиковый генератор: число - чистая функция (seed, stream, counter).
+// Общего для потоков состояния нет: стрим можно читать из любого потока
+// и в любом порядке, результат от этого не меняется.
+// Смешивание - финализатор splitmix64.
+class CounterRng {
+public:
+    CounterRng(std::uint64_t seed, std::uint64_t stream)
+        : key(mix(seed ^ mix(stream + GOLDEN))) {}
+
+    static constexpr std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Произвольный доступ: at(n) не зависит от предыдущих вызовов
+    std::uint64_t at(std::uint64_t n) const { return mix(key + (n + 1) * GOLDEN); }
+
+    std::uint64_t next() { return at(counter++); }
+
+    // Равномерно в [0, n) умножением вместо деления (Lemire)
+    std::uint32_t uniform(std::uint32_t n) {
+        return static_cast<std::uint32_t>(((next() >> 32) * n) >> 32);
+    }
+
+    std::uint64_t position() const { return counter; }
+
+private:
+    static constexpr std::uint64_t GOLDEN = 0x9e3779b97f4a7c15ULL;
+
+    std::uint64_t key;
+    std::uint64_t counter{0};
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Пакетные ядра над столбцами мира. Каждое ядро есть в скалярном виде
+// (эталон) и в SSE4.1/AVX2; нужный вариант выбирается при запуске по
+// возможностям процессора. Все варианты дают бит в бит одинаковый результат.
+//
+// Константы конфигурации по умолчанию подставлены при компиляции только в
+// движение и поиск близких пар. Разбор боёв ядра не получил: исход пары -
+// одна загрузка из матрицы npc_registry(), а пары зависят друг от друга
+// (убитый в одной не дерётся в следующей), поэтому их нельзя ни
+// векторизовать, ни ускорить константами вместо матрицы.
+enum class SimdLevel {
+    Scalar = 0,
+    Sse41,
+    Avx2
+};
+
+// Лучший уровень, который поддерживает процессор (определяется один раз)
+SimdLevel detected_simd_level();
+const char *simd_level_name(SimdLevel level);
+
+// Столбцы для шага движения. dirs[i]: бит 0 - вправо по x, бит 1 - вниз по y,
+// иначе в обратную сторону. Шаг - steps[types[i]] (типы за концом steps
+// стоят на месте); координата меняется, только если
+// остаётся в [0, max]. Мёртвые не двигаются.
+// Для шагов DEFAULT_MOVE_RANGES скалярный вариант собран с константами.
+struct MoveBatch {
+    int *xs;
+    int *ys;
+    const std::uint8_t *types;
+    const std::uint8_t *alive;
+    const std::uint8_t *dirs;
+    std::span<const int> steps;
+    size_t count;
+};
+
+void move_batch(const MoveBatch &batch, int max_x, int max_y);
+void move_batch(const MoveBatch &batch, int max_x, int max_y, SimdLevel level);
+
+// out[i] = dx * dx + dy * dy для пары (a[i], b[i]); разность - как в
+// World::is_close, в 32 битах, квадраты - в 64
+void squared_distances(const int *xs, const int *ys,
+                       const std::uint32_t *a, const std::uint32_t *b,
+                       size_t count, std::uint64_t *out);
+void squared_distances(const int *xs, const int *ys,
+                       const std::uint32_t *a, const std::uint32_t *b,
+                       size_t count, std::uint64_t *out, SimdLevel level);
+
+// Записывает в out номера пар, у которых dx * dx + dy * dy <= distance^2,
+// по возрастанию; возвращает их число. out - не меньше count элементов.
+// Для DEFAULT_KILL_DISTANCE граница подставлена на этапе компиляции.
+size_t close_pairs(const int *xs, const int *ys,
+                   const std::uint32_t *a, const std::uint32_t *b,
+                   size_t count, int distance, std::uint32_t *out);
+size_t close_pairs(const int *xs, const int *ys,
+                   const std::uint32_t *a, const std::uint32_t *b,
+                   size_t count, int distance, std::uint32_t *out, SimdLevel level);
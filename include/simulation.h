@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "world.h"
+#include "spatial_grid.h"
+#include "region_fights.h"
+#include "event_bus.h"
+#include "tick_scheduler.h"
+#include "population_history.h"
+#include "spawn_stage.h"
+#include "fight_manager.h"
+
+struct PopulationSpec {
+    size_t orcs{5};
+    size_t knights{3};
+    size_t bears{2};
+    // Фракции из реестра (npc_registry.h); расселяются после встроенных
+    std::vector<std::pair<NpcType, size_t>> others{};
+
+    void set(NpcType type, size_t count);
+};
+
+struct SimulationConfig {
+    std::uint64_t seed{0};
+    PopulationSpec population;
+    int max_x{500};
+    int max_y{500};
+    int distance{DEFAULT_KILL_DISTANCE}; // радиус боя и размер клетки сетки
+    MoveRanges move_ranges; // пусто - шаги из реестра
+    size_t ticks{30};
+    size_t fight_workers{1};
+    size_t history_ticks{4096}; // глубина кольцевого буфера численности
+    std::vector<SpawnRate> spawn_rates; // рождения по ходу игры (spawn_stage.h)
+    size_t population_cap{0};           // 0 - без предела живых для рождений
+    // Бои разбирает фоновый поток FightManager: Detect ставит пары через
+    // add_candidate, фаза Fight не ждёт. Исход зависит от расписания потоков
+    bool fight_thread{false};
+};
+
+// Начальное расселение cfg.population по всей карте: позиции и имена из
+// стрима расселения CounterRng, фракции по порядку (встроенные, затем others)
+void place_population(const SimulationConfig &config,
+                      const std::function<void(NpcType, int, int, const std::string &)> &place);
+
+struct SimulationResult {
+    size_t ticks{0};
+    size_t knights{0};
+    size_t orcs{0};
+    size_t bears{0};
+    size_t dead{0};
+    std::uint64_t checksum{0}; // хэш позиций и флагов жизни всех сущностей
+};
+
+// Детерминированная симуляция без вывода: Move -> Detect -> Fight -> Observe.
+// Случайность только из CounterRng с ключом (seed, id сущности, такт),
+// поэтому при одинаковой конфигурации результат совпадает бит в бит
+// независимо от того, какие потоки и в каком порядке его считали.
+// Разбор боёв детерминирован при фиксированном fight_workers, если
+// не включён fight_thread.
+class Simulation {
+public:
+    explicit Simulation(const SimulationConfig &config);
+    // Продолжить готовый мир (загруженный снимок); population не используется
+    Simulation(const SimulationConfig &config, std::unique_ptr<World> world);
+    // Симуляция части карты (чанк ChunkedWorld): сетка соседей только над
+    // area, ходы ограничены границами мира
+    Simulation(const SimulationConfig &config, std::unique_ptr<World> world, const MapArea &area);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    World &get_world() { return *world; }
+    const World &get_world() const { return *world; }
+    EventBus &events() { return bus; }
+    // Численность после фазы Fight каждого такта
+    const PopulationHistory &history() const { return population; }
+    const SimulationConfig &config() const { return cfg; }
+
+    void move_phase(size_t tick);
+    void detect_phase(size_t tick);
+    void fight_phase(size_t tick);
+    // Хоронит убитых за такт и убирает их из сетки
+    void compact_phase(size_t tick);
+    void spawn_phase(size_t tick);
+    // Всё после боёв: численность в историю, раздача шины, похороны, рождения
+    void end_tick(size_t tick);
+
+    // Новый NPC в мире и сетке (приход из соседнего чанка)
+    EntityId spawn(NpcType type, int x, int y, std::string_view name);
+    // Живой NPC уходит из мира без записи в мёртвые; слот - в арену
+    void emigrate(EntityId id);
+
+    // Регистрирует фазы Move/Detect/Fight/Compact, раздачу шины в Observe
+    // и Spawn, если заданы spawn_rates
+    void attach(TickScheduler &scheduler);
+
+    // Останавливает поток боёв и разбирает остаток его очереди;
+    // без fight_thread ничего не делает
+    void finish();
+
+    // Headless-прогон config().ticks тактов без ожидания
+    SimulationResult run();
+    SimulationResult summary() const;
+
+private:
+    void populate();
+
+    SimulationConfig cfg;
+    std::unique_ptr<World> world;
+    SpatialGrid grid;
+    RegionFightResolver resolver;
+    EventBus bus;
+    PopulationHistory population;
+    SpawnStage spawner;
+    std::vector<FightPair> fights;
+    size_t ticks_done{0};
+    std::unique_ptr<FightManager> fight_queue; // только при fight_thread
+    std::thread fight_worker;
+
+    // Буферы пакетных ядер, переиспользуются между тактами
+    std::vector<std::uint8_t> dirs;
+    std::vector<int> old_xs;
+    std::vector<int> old_ys;
+    std::vector<std::uint32_t> pair_a;
+    std::vector<std::uint32_t> pair_b;
+    std::vector<std::uint32_t> pair_close;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "world.h"
+
+// Бинарный снимок мира (little-endian, все секции выровнены на 8 байт):
+//   SnapshotHeader
+//   uint8  type[count]
+//   uint8  alive[count]
+//   int32  x[count]
+//   int32  y[count]
+//   uint32 name_id[count]
+//   uint32 name_offset[names + 1]  - смещения строк в блоке имён
+//   char   name_bytes[names_bytes]
+// Имена хранятся таблицей один раз, записи ссылаются на них по индексу.
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t max_x;
+    std::int32_t max_y;
+    std::uint64_t count;
+    std::uint64_t names;
+    std::uint64_t names_bytes;
+};
+
+constexpr char SNAPSHOT_MAGIC[4] = {'L', '7', 'W', 'S'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+bool save_snapshot(const World &world, const std::string &path);
+// Файл отображается через mmap, столбцы копируются в мир целиком.
+// При ошибке пишет причину в std::cerr и возвращает nullptr.
+std::unique_ptr<World> load_snapshot(const std::string &path);
+
+// Текстовый формат NPC::save: тип, x, y, имя - по значению в строке.
+// Флаг alive в нём не хранится, все загруженные NPC живы.
+void save_text(const World &world, std::ostream &os);
+size_t load_text(World &world, std::istream &is);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Прямоугольник карты [min_x, max_x] x [min_y, max_y]
+struct MapArea {
+    int min_x{0};
+    int min_y{0};
+    int max_x{-1};
+    int max_y{-1};
+
+    bool empty() const { return max_x < min_x || max_y < min_y; }
+};
+
+// Равномерная сетка для поиска соседей. Размер ячейки равен радиусу боя,
+// поэтому оба участника любой близкой пары лежат в одной или соседних ячейках.
+class SpatialGrid {
+public:
+    using id_t = std::uint32_t;
+
+    SpatialGrid(int max_x, int max_y, int cell_size);
+    // Сетка только над областью (чанк большой карты); точки вне неё
+    // ложатся в крайние ячейки
+    SpatialGrid(const MapArea &area, int cell_size);
+
+    void clear();
+    void insert(id_t id, int x, int y);
+    bool remove(id_t id, int x, int y);
+    // Убирает пачку id (sorted - по возрастанию); координаты берутся по id.
+    // Порядок оставшихся в ячейках не меняется. Возвращает число убранных
+    size_t remove_sorted(std::span<const id_t> sorted, std::span<const int> xs, std::span<const int> ys);
+    // Перекладывает id только если он сменил ячейку
+    void update(id_t id, int old_x, int old_y, int new_x, int new_y);
+
+    size_t size() const { return count; }
+    int cell_size() const { return cell; }
+
+    // Каждая неупорядоченная пара из своей и соседних ячеек ровно один раз
+    template <typename F>
+    void for_each_candidate_pair(F &&f) const;
+
+    // Все id из ячейки точки (x, y) и восьми соседних
+    template <typename F>
+    void for_each_near(int x, int y, F &&f) const;
+
+private:
+    size_t cell_index(int x, int y) const;
+
+    int cell;
+    int origin_x{0};
+    int origin_y{0};
+    int cells_x;
+    int cells_y;
+    size_t count{0};
+    std::vector<std::vector<id_t>> cells;
+};
+
+template <typename F>
+void SpatialGrid::for_each_candidate_pair(F &&f) const {
+    // Половина окрестности: справа, снизу-слева, снизу, снизу-справа
+    static constexpr int offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    for (int cy = 0; cy < cells_y; ++cy) {
+        for (int cx = 0; cx < cells_x; ++cx) {
+            const auto &home = cells[cx + cy * cells_x];
+            if (home.empty())
+                continue;
+
+            for (size_t i = 0; i < home.size(); ++i)
+                for (size_t j = i + 1; j < home.size(); ++j)
+                    f(home[i], home[j]);
+
+            for (auto &o : offsets) {
+                int nx = cx + o[0];
+                int ny = cy + o[1];
+                if (nx < 0 || nx >= cells_x || ny >= cells_y)
+                    continue;
+                const auto &other = cells[nx + ny * cells_x];
+                for (id_t a : home)
+                    for (id_t b : other)
+                        f(a, b);
+            }
+        }
+    }
+}
+
+template <typename F>
+void SpatialGrid::for_each_near(int x, int y, F &&f) const {
+    size_t index = cell_index(x, y);
+    int cx = static_cast<int>(index % cells_x);
+    int cy = static_cast<int>(index / cells_x);
+
+    for (int ny = cy - 1; ny <= cy + 1; ++ny) {
+        if (ny < 0 || ny >= cells_y)
+            continue;
+        for (int nx = cx - 1; nx <= cx + 1; ++nx) {
+            if (nx < 0 || nx >= cells_x)
+                continue;
+            for (id_t id : cells[nx + ny * cells_x])
+                f(id);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "world.h"
+#include "spatial_grid.h"
+
+// Скорость рождения фракции: per_tick NPC за такт, дробная часть
+// набегает (0.25 - один NPC каждые четыре такта)
+struct SpawnRate {
+    NpcType type{Unknown};
+    double per_tick{0};
+};
+
+// Непрерывное рождение NPC пачкой в конце такта. Сколько родится на такте
+// tick, зависит только от tick; позиции и имена - от (seed, tick),
+// как у CounterRng. Пачка заранее резервирует столбцы мира (с запасом
+// вдвое, чтобы поток рождений не перевыделял их каждый такт) и занимает
+// сначала освобождённые compact() слоты. Новые id сразу кладутся в сетку.
+//
+// population_cap > 0 - рождения такта урезаются так, чтобы живых
+// было не больше cap.
+class SpawnStage {
+public:
+    SpawnStage(std::uint64_t seed, std::span<const SpawnRate> rates, size_t population_cap = 0);
+
+    bool empty() const { return rates.empty(); }
+    // Плановое число рождений фракции rates[i] на такте tick
+    size_t planned(size_t i, size_t tick) const;
+
+    // Рождает пачку такта tick; возвращает число родившихся
+    size_t run(World &world, SpatialGrid &grid, size_t tick);
+
+private:
+    std::uint64_t seed;
+    std::vector<SpawnRate> rates;
+    size_t cap;
+    std::vector<size_t> counts; // буфер пачки по фракциям
+};
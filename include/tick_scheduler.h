@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Фазы такта в порядке выполнения
+enum class TickPhase {
+    Move = 0,
+    Detect,
+    Fight,
+    Observe,
+    Render,
+    Compact, // уборка мёртвых, когда на них уже никто не ссылается
+    Spawn,   // рождения в освободившиеся слоты
+    Count
+};
+
+// Планировщик с фиксированным шагом: каждый такт выполняет фазы по порядку
+// и ждёт начала следующего такта. tick_rate == 0 - без ожидания
+// (headless-режим, столько тактов в секунду, сколько успеет процессор).
+class TickScheduler {
+public:
+    using phase_fn = std::function<void(size_t tick)>;
+
+    explicit TickScheduler(double ticks_per_second = 1.0);
+
+    void on(TickPhase phase, phase_fn fn);
+
+    void set_tick_rate(double ticks_per_second);
+    double tick_rate() const { return rate; }
+
+    // Выполняет до max_ticks тактов; возвращает число выполненных
+    size_t run(size_t max_ticks);
+    // Можно вызывать из любого потока и из фаз: текущий такт доигрывается
+    void request_stop() { stop_requested = true; }
+    bool stopped() const { return stop_requested; }
+
+    size_t tick() const { return current; }
+
+private:
+    void run_tick();
+
+    double rate;
+    std::chrono::steady_clock::duration period{};
+    std::array<std::vector<phase_fn>, static_cast<size_t>(TickPhase::Count)> phases;
+    std::atomic<bool> stop_requested{false};
+    size_t current{0};
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+#include "fight_table.h"
+
+// Победитель боя - фракция со строго наибольшим числом выживших,
+// иначе ничья (Unknown)
+NpcType battle_winner(const SimulationResult &result);
+
+struct TournamentConfig {
+    SimulationConfig battle;   // seed не используется: бой i играет с first_seed + i
+    std::uint64_t first_seed{0};
+    size_t battles{100};
+    size_t threads{0};         // 0 - по числу ядер
+    double z{1.96};            // 95% доверительный интервал
+};
+
+struct WinRate {
+    size_t wins{0};
+    double rate{0.0};
+    double low{0.0};  // границы интервала Уилсона
+    double high{0.0};
+};
+
+struct TournamentResult {
+    size_t battles{0};
+    size_t draws{0};
+    std::array<WinRate, NPC_TYPE_COUNT> factions{}; // индекс - NpcType
+    std::vector<SimulationResult> results;          // results[i] - бой с first_seed + i
+};
+
+// Интервал Уилсона для доли wins / n
+WinRate wilson_interval(size_t wins, size_t n, double z);
+
+// Монте-Карло турнир: независимые бои раздаются пулу потоков через общий
+// счётчик, у каждого боя свой мир, сетка и разбор боёв. Каждый бой играет
+// в один поток разбора, поэтому итог не зависит от числа потоков пула.
+TournamentResult run_tournament(const TournamentConfig &config);
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <shared_mutex>
+#include "npc.h"
+#include "name_table.h"
+
+using EntityId = std::uint32_t;
+
+// Ссылка на слот мира с поколением: после release слот может занять
+// другая сущность, и старые ссылки на него перестают быть действительными.
+// 8 байт вместо пары shared_ptr в событиях боя.
+struct EntityHandle {
+    EntityId id{0};
+    std::uint32_t generation{0};
+
+    bool operator==(const EntityHandle &) const = default;
+};
+static_assert(sizeof(EntityHandle) == 8);
+
+// Численность по фракциям; индекс alive - NpcType
+struct PopulationCounts {
+    std::array<size_t, MAX_NPC_TYPES> alive{};
+    size_t dead{0};
+
+    size_t of(NpcType type) const { return alive[type]; }
+    size_t total_alive() const;
+};
+
+// Запись кладбища: кто, где и на каком такте похоронен compact().
+// Имя - id в таблице имён мира (она только растёт)
+struct GraveRecord {
+    std::uint32_t name_id{0};
+    std::int32_t x{0};
+    std::int32_t y{0};
+    std::uint32_t tick{0};
+    std::uint8_t type{Unknown};
+};
+
+// Хранилище мира в виде параллельных массивов (structure of arrays).
+// id сущности - её индекс в массивах. Столбцы работают как арена: мёртвый
+// слот можно вернуть release(), и следующий spawn займёт его без выделения
+// памяти, увеличив поколение слота. Пока слот не освобождён, id стабилен.
+// Проходы по x/y/type/alive идут по памяти линейно.
+//
+// Методы не блокируют сами: многопоточный код берёт mutex() на весь проход
+// (shared - на чтение, unique - на запись).
+//
+// live_ids() - занятые слоты без прохода по всем массивам: живые и убитые
+// после последнего compact(). compact() на границе тактов хоронит мёртвых
+// пачкой: запись уходит в graveyard(), слот - в арену.
+//
+// Счётчики живых и мёртвых по типам ведут spawn/kill/assign, поэтому
+// population() - O(1). Счётчики атомарные: регионы разбора боёв убивают
+// свои сущности параллельно, а статистику читают без блокировки мира.
+class World {
+public:
+    World(int max_x, int max_y);
+
+    EntityId spawn(NpcType type, int x, int y, std::string_view name = {});
+    void reserve(size_t n);
+
+    size_t size() const { return xs.size(); }
+    size_t capacity() const { return xs.capacity(); }
+    // Байт под объект и столбцы (по ёмкости), без строк таблицы имён
+    size_t memory_bytes() const;
+    int max_x() const { return width; }
+    int max_y() const { return height; }
+
+    int x(EntityId id) const { return xs[id]; }
+    int y(EntityId id) const { return ys[id]; }
+    std::pair<int, int> position(EntityId id) const { return {xs[id], ys[id]}; }
+    NpcType type(EntityId id) const { return static_cast<NpcType>(types[id]); }
+    bool is_alive(EntityId id) const { return alive[id] != 0; }
+    // Освобождённый слот: тип Unknown и не жив
+    bool is_free(EntityId id) const { return types[id] == Unknown && !alive[id]; }
+
+    EntityHandle handle(EntityId id) const { return {id, generations[id]}; }
+    bool is_valid(EntityHandle h) const {
+        return h.id < xs.size() && generations[h.id] == h.generation && !is_free(h.id);
+    }
+    // Возвращает мёртвый слот в арену; живых не трогает (тогда false)
+    bool release(EntityId id);
+    size_t free_slots() const { return free_list.size(); }
+
+    // Живые и убитые после последнего compact(), в порядке появления
+    std::span<const EntityId> live_ids() const { return live; }
+    // Хоронит мёртвых из live_ids(): запись в кладбище, слот в арену.
+    // Звать, когда на мёртвые id больше не ссылаются (конец такта).
+    // Возвращает число похороненных; их id по возрастанию - buried()
+    size_t compact(std::uint32_t tick);
+    std::span<const EntityId> buried() const { return last_buried; }
+    std::span<const GraveRecord> graveyard() const { return graves; }
+    std::string_view name(EntityId id) const { return names.view(name_ids[id]); }
+    std::uint32_t name_id(EntityId id) const { return name_ids[id]; }
+
+    // Заменяет содержимое мира готовыми столбцами (загрузка снимка)
+    void assign(std::span<const std::uint8_t> type_column,
+                std::span<const int> x_column,
+                std::span<const int> y_column,
+                std::span<const std::uint8_t> alive_column,
+                std::span<const std::uint32_t> name_column,
+                std::span<const std::string_view> name_table);
+
+    // Шаг типа - move_ranges(); неизвестные типы стоят на месте
+    void move(EntityId id, int shift_x, int shift_y);
+    // Шаг всех сущностей векторным ядром: dirs[id] - биты направления
+    // (бит 0 - +x, бит 1 - +y), результат как у move для каждого id
+    void move_all(std::span<const std::uint8_t> dirs);
+    // По умолчанию - шаги из npc_registry() на момент создания мира
+    const MoveRanges &move_ranges() const { return ranges; }
+    void set_move_ranges(std::span<const int> r) { ranges.assign(r.begin(), r.end()); }
+    // Повторное убийство мёртвого счётчики не трогает
+    void kill(EntityId id);
+    bool is_close(EntityId a, EntityId b, int distance) const;
+
+    std::span<const int> x_data() const { return xs; }
+    std::span<const int> y_data() const { return ys; }
+    std::span<const std::uint8_t> type_data() const { return types; }
+    std::span<const std::uint8_t> alive_data() const { return alive; }
+    std::span<const std::uint32_t> name_data() const { return name_ids; }
+    const NameTable &name_table() const { return names; }
+
+    std::shared_mutex &mutex() const { return mtx; }
+
+    PopulationCounts population() const;
+    size_t alive_count(NpcType type) const { return alive_by_type[type].load(std::memory_order_relaxed); }
+    // Мёртвые в слотах и на кладбище; release() мёртвого из счёта убирает
+    size_t dead_count() const { return dead_total.load(std::memory_order_relaxed); }
+
+private:
+    // Неизвестные типы из файлов учитываются как Unknown
+    static size_t type_slot(std::uint8_t type) { return type < MAX_NPC_TYPES ? type : static_cast<size_t>(Unknown); }
+
+    int width;
+    int height;
+    MoveRanges ranges;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    std::vector<std::uint8_t> types;
+    std::vector<std::uint8_t> alive;
+    std::vector<std::uint32_t> name_ids;
+    std::vector<std::uint32_t> generations;
+    std::vector<EntityId> free_list;
+    std::vector<EntityId> live;
+    std::vector<std::uint8_t> listed; // id уже в live (release() его оттуда не убирает)
+    std::vector<EntityId> last_buried;
+    std::vector<GraveRecord> graves;
+
+    // Одинаковые имена хранятся один раз; строки не перемещаются
+    NameTable names;
+
+    std::array<std::atomic<size_t>, MAX_NPC_TYPES> alive_by_type{};
+    std::atomic<size_t> dead_total{0};
+
+    mutable std::shared_mutex mtx;
+};
+
+// Печать сущности в формате NPC::print: "Orc Grom: { x:1, y:2, name:"Grom"} "
+std::ostream &print_entity(std::ostream &os, const World &world, EntityId id);
+// То же для похороненного
+std::ostream &print_grave(std::ostream &os, const World &world, const GraveRecord &grave);
@@ -1,432 +1,456 @@
 #include <sstream>
+#include <cstdlib>
 #include <atomic>
-#include <thread>
-#include <optional>
-#include <array>
 #include <chrono>
-#include <queue>
 #include <mutex>
-#include <fstream>
 #include <shared_mutex>
 #include <iomanip>
+#include <fstream>
+#include <random>
+#include <csignal>
+#include <unistd.h>
 #include "include/npc.h"
-#include "include/orc.h"
-#include "include/knight.h"
-#include "include/bear.h"
+#include "include/world.h"
+#include "include/tick_scheduler.h"
+#include "include/async_logger.h"
+#include "include/snapshot.h"
+#include "include/event_bus.h"
+#include "include/simulation.h"
+#include "include/tournament.h"
+#include "include/frame_renderer.h"
+#include "include/config_file.h"
+#include "include/metrics.h"
+#include "include/chunked_world.h"
 
-using namespace std::chrono_literals;
-std::mutex console_mutex;
-std::mutex file_mutex;
-std::ofstream log_file("game_log.txt");
+// Наблюдатели подписываются на шину мира только на победы (FightFilter::WinsOnly).
+// Каждый принадлежит своей игре: консольный получает её мьютекс вывода,
+// файловый - свой лог.
+class ConsoleObserver : public IFightBatchObserver {
+private:
+    std::mutex &console_mutex;
 
-class ConsoleObserver : public IFightObserver {
 public:
-
-    ConsoleObserver() = default;
+    explicit ConsoleObserver(std::mutex &console) : console_mutex(console) {}
     
     ConsoleObserver(const ConsoleObserver&) = delete;
     ConsoleObserver& operator=(const ConsoleObserver&) = delete;
 
-    static std::shared_ptr<IFightObserver> get() {
-        static std::shared_ptr<ConsoleObserver> instance = 
-            std::make_shared<ConsoleObserver>();
-        return instance;
-    }
-
-    void on_fight(const std::shared_ptr<NPC> attacker, 
-                  const std::shared_ptr<NPC> defender, 
-                  bool win) override {
-        if (win) {
-            std::lock_guard<std::mutex> lock(console_mutex);
-            std::cout << std::endl << "=== MURDER ===" << std::endl;
-            std::cout << "Attacker: ";
-            attacker->print();
-            std::cout << "Defender: ";
-            defender->print();
-            std::cout << "=============" << std::endl << std::endl;
+    void on_fights(const World &world, std::span<const FightRecord> fights) override {
+        std::ostringstream out;
+        for (auto &fight : fights) {
+            out << "\n=== MURDER ===\n";
+            out << "Attacker: ";
+            print_entity(out, world, fight.attacker);
+            out << "Defender: ";
+            print_entity(out, world, fight.defender);
+            out << "=============\n\n";
         }
+        std::lock_guard<std::mutex> lock(console_mutex);
+        std::cout << out.str() << std::flush;
     }
 };
 
-class FileObserver : public IFightObserver {
+class FileObserver : public IFightBatchObserver {
 private:
-    std::ofstream log_file;
+    AsyncLogger log_file;
     
 public:
-    FileObserver() {
-        log_file.open("battle_log.txt", std::ios::app);
-    }
-    
-    ~FileObserver() {
-        if (log_file.is_open()) {
-            log_file.close();
-        }
-    }
+    explicit FileObserver(const std::string &path) : log_file(path, true) {}
     
     // Запрещаем копирование
     FileObserver(const FileObserver&) = delete;
     FileObserver& operator=(const FileObserver&) = delete;
 
-    static std::shared_ptr<IFightObserver> get() {
-        static std::shared_ptr<FileObserver> instance = 
-            std::make_shared<FileObserver>();
-        return instance;
-    }
-
-    void on_fight(const std::shared_ptr<NPC> attacker, 
-                  const std::shared_ptr<NPC> defender, 
-                  bool win) override {
-        if (win) {
-            std::lock_guard<std::mutex> lock(file_mutex);
-            log_file << std::endl << "=== MURDER ===" << std::endl;
-            log_file << "Attacker: ";
-            attacker->print(log_file);
-            log_file << "Defender: ";
-            defender->print(log_file);
-            log_file << "=============" << std::endl << std::endl;
+    void on_fights(const World &world, std::span<const FightRecord> fights) override {
+        // Пачка форматируется в памяти, на диск её унесёт фоновый поток
+        std::ostringstream record;
+        for (auto &fight : fights) {
+            record << "\n=== MURDER ===\n";
+            record << "Attacker: ";
+            print_entity(record, world, fight.attacker);
+            record << "Defender: ";
+            print_entity(record, world, fight.defender);
+            record << "=============\n\n";
         }
+        log_file.log(record.str());
     }
 };
-//фабрика из файла
-std::shared_ptr<NPC> factory(std::istream &is) {
-    std::shared_ptr<NPC> result;
-    int type{0};
-    if (is >> type) {
-        switch (type)
-        {
-        case OrcType:
-            result = std::make_shared<Orc>(is);
-            break;
-        case KnightType:
-            result = std::make_shared<Knight>(is);
-            break;
-        case BearType:
-            result = std::make_shared<Bear>(is);
-            break;
+// Мир из файла: *.txt - текстовый формат NPC::save, иначе бинарный снимок
+std::unique_ptr<World> load_world(const std::string &path, int max_x, int max_y) {
+    if (path.ends_with(".txt")) {
+        std::ifstream is(path);
+        if (!is) {
+            std::cerr << "cannot open " << path << std::endl;
+            return nullptr;
         }
+        auto world = std::make_unique<World>(max_x, max_y);
+        load_text(*world, is);
+        return world;
     }
-    else
-        std::cerr << "unexpected NPC type:" << type << std::endl;
+    return load_snapshot(path);
+}
 
-    if (result) {
-        result->subscribe(ConsoleObserver::get());
-        result->subscribe(FileObserver::get());
+bool save_world(const World &world, const std::string &path) {
+    if (path.ends_with(".txt")) {
+        std::ofstream os(path);
+        save_text(world, os);
+        return static_cast<bool>(os);
     }
-    return result;
+    return save_snapshot(world, path);
 }
 
-//фабрика из параметров
-std::shared_ptr<NPC> factory(NpcType type, int x, int y) {
-    std::shared_ptr<NPC> result;
-    switch (type)
-    {
-    case OrcType:
-        result = std::make_shared<Orc>(x, y);
-        break;
-    case KnightType:
-        result = std::make_shared<Knight>(x, y);
-        break;
-    case BearType:
-        result = std::make_shared<Bear>(x, y);
-        break;
-    default:
-        break;
+// Мёртвые - сначала кладбище (в порядке похорон), затем ещё не похороненные
+void print_entities(std::ostream &os, const World &world, bool alive, const char *prefix = "") {
+    if (!alive) {
+        for (const GraveRecord &grave : world.graveyard()) {
+            os << prefix;
+            print_grave(os, world, grave);
+        }
     }
-    if (result) {
-        result->subscribe(ConsoleObserver::get());
-        result->subscribe(FileObserver::get());
+    for (EntityId id : world.live_ids()) {
+        if (world.is_alive(id) == alive) {
+            os << prefix;
+            print_entity(os, world, id);
+        }
     }
-    return result;
 }
 
-std::ostream &operator<<(std::ostream &os, const set_t &array) {
-    for (auto &n : array)
-        n->print();
-    return os;
+// Численность по тактам в CSV (PopulationHistory::export_csv)
+bool save_history(const PopulationHistory &history, const std::string &path) {
+    std::ofstream os(path);
+    history.export_csv(os);
+    return static_cast<bool>(os);
 }
 
-void print_to_file(std::ofstream &fs, const set_t &array) {
-    for (auto &n : array)
-        n->print(fs);
+// SIGUSR1 просит отчёт метрик; пишет его фаза Observe ближайшего такта
+std::atomic<bool> metrics_requested{false};
+
+void on_metrics_signal(int) {
+    metrics_requested = true;
 }
 
-bool k = true, m = true;
-struct FightEvent {
-    std::shared_ptr<NPC> attacker;
-    std::shared_ptr<NPC> defender;
-};
+// *.json - JSON, иначе текстовый формат Prometheus; пустой путь - в stderr
+bool save_metrics(const std::string &path) {
+    if (path.empty()) {
+        metrics().export_prometheus(std::cerr);
+        return true;
+    }
+    std::ofstream os(path);
+    if (path.ends_with(".json"))
+        metrics().export_json(os);
+    else
+        metrics().export_prometheus(os);
+    if (!os)
+        std::cerr << "cannot write metrics: " << path << std::endl;
+    return static_cast<bool>(os);
+}
 
-class FightManager {
-private:
-    std::queue<FightEvent> events;
-    std::shared_mutex mtx;
-    FightManager() {}
+void watch_metrics_requests(TickScheduler &scheduler, const std::string &path) {
+    std::signal(SIGUSR1, on_metrics_signal);
+    scheduler.on(TickPhase::Observe, [path](size_t) {
+        if (metrics_requested.exchange(false))
+            save_metrics(path);
+    });
+}
 
-public:
-    static FightManager &get() {
-        static FightManager instance;
-        return instance;
-    }
+// Пакетный прогон: без консоли, сетки и наблюдателей, только итог
+int run_headless(Simulation &sim, const std::string &save_path, const std::string &history_path,
+                 const std::string &metrics_path) {
+    auto started = std::chrono::steady_clock::now();
+    TickScheduler scheduler(0.0);
+    sim.attach(scheduler);
+    watch_metrics_requests(scheduler, metrics_path);
+    scheduler.run(sim.config().ticks);
+    SimulationResult result = sim.summary();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    std::cout << "seed=" << sim.config().seed
+              << " ticks=" << result.ticks
+              << " knights=" << result.knights
+              << " orcs=" << result.orcs
+              << " bears=" << result.bears
+              << " dead=" << result.dead
+              << " checksum=" << std::hex << std::setw(16) << std::setfill('0') << result.checksum
+              << std::dec << std::setfill(' ')
+              << " ticks/s=" << (elapsed.count() > 0 ? result.ticks / elapsed.count() : 0.0)
+              << std::endl;
+
+    if (!save_path.empty() && !save_world(sim.get_world(), save_path))
+        return 1;
+    if (!history_path.empty() && !save_history(sim.history(), history_path))
+        return 1;
+    if (!metrics_path.empty() && !save_metrics(metrics_path))
+        return 1;
+    return 0;
+}
+
+// Пакетный прогон чанкового мира: каждый резидентный чанк - своя Simulation,
+// тихие чанки выгружаются на диск по бюджету памяти
+int run_chunked(const SimulationConfig &config, const ChunkConfig &chunks, const std::string &metrics_path) {
+    auto started = std::chrono::steady_clock::now();
+    ChunkedWorld world(config, chunks);
+    world.populate();
+    for (size_t tick = 0; tick < config.ticks; ++tick)
+        world.tick(tick);
+    PopulationCounts counts = world.counts();
+    ChunkStats stats = world.stats();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
 
-    void add_event(FightEvent &&event) {
-        std::lock_guard<std::shared_mutex> lock(mtx);
-        events.push(event);
+    std::cout << "seed=" << config.seed
+              << " ticks=" << config.ticks
+              << " knights=" << counts.of(KnightType)
+              << " orcs=" << counts.of(OrcType)
+              << " bears=" << counts.of(BearType)
+              << " dead=" << counts.dead
+              << " chunks=" << stats.resident << "+" << stats.paged
+              << " page_ins=" << stats.page_ins
+              << " page_outs=" << stats.page_outs
+              << " resident_mb=" << static_cast<double>(stats.resident_bytes) / (1 << 20)
+              << " ticks/s=" << (elapsed.count() > 0 ? config.ticks / elapsed.count() : 0.0)
+              << std::endl;
+
+    if (!metrics_path.empty() && !save_metrics(metrics_path))
+        return 1;
+    return 0;
+}
+
+// Турнир из battles боёв с зёрнами seed, seed + 1, ...
+int run_tournament_report(const SimulationConfig &battle, size_t battles, size_t threads) {
+    TournamentConfig config;
+    config.battle = battle;
+    config.first_seed = battle.seed;
+    config.battles = battles;
+    config.threads = threads;
+
+    auto started = std::chrono::steady_clock::now();
+    TournamentResult result = run_tournament(config);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    std::cout << "=== Tournament: " << result.battles << " battles, seeds "
+              << config.first_seed << ".." << config.first_seed + battles - 1 << " ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    for (NpcType type : {OrcType, KnightType, BearType}) {
+        const WinRate &rate = result.factions[type];
+        std::cout << std::setw(7) << type_name(type) << ": wins " << std::setw(6) << rate.wins
+                  << "  rate " << rate.rate
+                  << "  95% CI [" << rate.low << ", " << rate.high << "]" << std::endl;
     }
+    std::cout << "  Draws: " << result.draws << std::endl;
+    std::cout << "Elapsed: " << elapsed.count() << " s ("
+              << (elapsed.count() > 0 ? result.battles / elapsed.count() : 0.0) << " battles/s)" << std::endl;
+    return 0;
+}
 
-    void operator()() {
-        while (k) {
-            std::optional<FightEvent> event;
-            {
-                std::lock_guard<std::shared_mutex> lock(mtx);
-                if (!events.empty()) {
-                    event = events.front();
-                    events.pop();
-                }
+int main(int argc, char **argv) {
+    // --fight-workers N: число потоков разбора боёв (по регионам карты)
+    //                    Интерактивная игра разбирает бои фоновым потоком FightManager,
+    //                    --headless и --tournament - детерминированно внутри такта
+    // --tick-rate HZ:     тактов в секунду
+    // --ticks N:          сколько тактов играть
+    // --headless:         пакетный прогон без отрисовки, печатает одну строку итога
+    // --seed S:           зерно; одинаковые параметры дают одинаковый результат
+    // --orcs/--knights/--bears N: состав армий
+    // --map W[xH]:        размер карты
+    // --tournament N:    N пакетных боёв с зёрнами seed..seed+N-1, итог - доли побед
+    // --threads N:       потоков турнира (по умолчанию - по числу ядер)
+    // --load PATH:        начать с сохранённого мира (*.txt - текстовый формат)
+    // --save PATH:        сохранить мир после игры
+    // --history PATH:     численность фракций по тактам в CSV
+    // --spawn-rate T=R:    рождать R NPC типа T за такт (как rate.T в конфиге)
+    // --population-cap N: рождения только пока живых меньше N
+    // --config PATH:      параметры из файла (config_file.h); флаги после него перекрывают файл
+    // --metrics PATH:     счётчики и задержки фаз в конце игры (*.json - JSON, иначе Prometheus);
+    //                     по SIGUSR1 - в любой момент (без --metrics - в stderr)
+    // --chunk-size N:     чанковый мир со стороной чанка N, пакетный прогон без отрисовки;
+    //                     несовместим с --load/--save/--history/--spawn-rate/--population-cap
+    // --memory-budget MB: бюджет резидентных чанков (по умолчанию 64);
+    //                     выгруженные чанки замирают, поэтому исход зависит от бюджета
+    // --page-dir PATH:    куда выгружать чанки (по умолчанию - временный каталог)
+    GameConfig game;
+    SimulationConfig &config = game.sim;
+    config.seed = std::random_device{}();
+    double tick_rate = 1.0;
+    bool headless = false;
+    size_t tournament = 0, threads = 0;
+    ChunkConfig chunks;
+    bool chunked = false;
+    std::string load_path, save_path, history_path, metrics_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--headless")
+            headless = true;
+        else if (i + 1 < argc && arg == "--fight-workers")
+            config.fight_workers = std::max(1, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--tick-rate")
+            tick_rate = std::atof(argv[++i]);
+        else if (i + 1 < argc && arg == "--ticks")
+            config.ticks = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--seed")
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && arg == "--orcs")
+            config.population.orcs = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--knights")
+            config.population.knights = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--bears")
+            config.population.bears = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--map") {
+            if (!parse_map_size(argv[++i], config.max_x, config.max_y)) {
+                std::cerr << "bad map size: " << argv[i] << std::endl;
+                return 1;
             }
-            if (event) {
-                try {
-                    if (event->attacker->is_alive() && event->defender->is_alive()) {
-                        if (event->defender->accept(event->attacker)) {
-                            event->defender->must_die();
-                        }
-                    }
-                }
-                catch (...) {
-                    std::lock_guard<std::shared_mutex> lock(mtx);
-                    events.push(*event);
-                }
-            }
-            else
-                std::this_thread::sleep_for(100ms);
+        }
+        else if (i + 1 < argc && arg == "--tournament")
+            tournament = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--threads")
+            threads = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--load")
+            load_path = argv[++i];
+        else if (i + 1 < argc && arg == "--save")
+            save_path = argv[++i];
+        else if (i + 1 < argc && arg == "--history")
+            history_path = argv[++i];
+        else if (i + 1 < argc && arg == "--metrics")
+            metrics_path = argv[++i];
+        else if (i + 1 < argc && arg == "--spawn-rate") {
+            std::istringstream line("rate." + std::string(argv[++i]));
+            if (!parse_config(line, game, "--spawn-rate"))
+                return 1;
+        }
+        else if (i + 1 < argc && arg == "--population-cap")
+            config.population_cap = std::max(0, std::atoi(argv[++i]));
+        else if (i + 1 < argc && arg == "--chunk-size") {
+            chunks.chunk_size = std::max(1, std::atoi(argv[++i]));
+            chunked = true;
+        }
+        else if (i + 1 < argc && arg == "--memory-budget")
+            chunks.memory_budget = static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        else if (i + 1 < argc && arg == "--page-dir")
+            chunks.page_dir = argv[++i];
+        else if (i + 1 < argc && arg == "--config") {
+            if (!load_config(argv[++i], game))
+                return 1;
         }
     }
-};
 
-int main() {
+    if (tournament > 0)
+        return run_tournament_report(config, tournament, threads);
+    if (chunked) {
+        // Чанковый прогон не ведёт рождений, снимков и истории численности
+        const char *unsupported = !load_path.empty() ? "--load"
+            : !save_path.empty() ? "--save"
+            : !history_path.empty() ? "--history"
+            : !config.spawn_rates.empty() ? "--spawn-rate/rate.*"
+            : config.population_cap != 0 ? "--population-cap"
+            : nullptr;
+        if (unsupported) {
+            std::cerr << unsupported << " cannot be combined with --chunk-size" << std::endl;
+            return 1;
+        }
+        return run_chunked(config, chunks, metrics_path);
+    }
+    config.fight_thread = !headless;
+
+    std::unique_ptr<Simulation> sim_ptr;
+    if (load_path.empty()) {
+        sim_ptr = std::make_unique<Simulation>(config);
+    } else {
+        auto loaded = load_world(load_path, config.max_x, config.max_y);
+        if (!loaded)
+            return 1;
+        sim_ptr = std::make_unique<Simulation>(config, std::move(loaded));
+    }
+    Simulation &sim = *sim_ptr;
+    World &world = sim.get_world();
+
+    if (headless)
+        return run_headless(sim, save_path, history_path, metrics_path);
+
+    std::mutex console_mutex;
+    AsyncLogger game_log("game_log.txt");
+
+    std::ostringstream log_file; // копится в памяти и уходит в game_log пачкой
     log_file << "=== Game Start ===" << std::endl;
     std::cout << "=== Game Start ===" << std::endl;
-    
-    set_t array;
-    const int MAX_X{500};
-    const int MAX_Y{500};
-    const int DISTANCE{10};
 
-    std::cout << "Generating NPCs ... " << std::endl;
-    log_file << "Generating NPCs ... " << std::endl;
-    
-    // Создаем NPC с разными типами
-    for (size_t i = 0; i < 5; ++i) {
-        array.insert(factory(OrcType, std::rand() % 500, std::rand() % 500));
-    }
-    for (size_t i = 0; i < 3; ++i) {
-        array.insert(factory(KnightType, std::rand() % 500, std::rand() % 500));
-    }
-    for (size_t i = 0; i < 2; ++i) {
-        array.insert(factory(BearType, std::rand() % 500, std::rand() % 500));
+    if (!load_path.empty()) {
+        std::cout << "Loading NPCs from " << load_path << " ... " << std::endl;
+        log_file << "Loading NPCs from " << load_path << " ... " << std::endl;
+    } else {
+        std::cout << "Generating NPCs (seed " << config.seed << ") ... " << std::endl;
+        log_file << "Generating NPCs (seed " << config.seed << ") ... " << std::endl;
     }
 
-    std::cout << "Starting NPCs (" << array.size() << "): " << std::endl;
-    log_file << "Starting NPCs (" << array.size() << "): " << std::endl;
+    std::cout << "Starting NPCs (" << world.size() << "): " << std::endl;
+    log_file << "Starting NPCs (" << world.size() << "): " << std::endl;
     
-    std::cout << array;
-    print_to_file(log_file, array);
-
-    std::thread fight_thread(std::ref(FightManager::get()));
-
-    int count = 0;
-    std::thread move_thread([&array, MAX_X, MAX_Y, DISTANCE, &count]() {
-        while (m) {
-            for (std::shared_ptr<NPC> npc : array) {
-                if(npc->is_alive()){
-                    int shift_x = std::rand() % 20 - 10;
-                    int shift_y = std::rand() % 20 - 10;
-                    npc->move(shift_x, shift_y, MAX_X, MAX_Y);
-                }
-            }
-            for (std::shared_ptr<NPC> npc : array) {
-                for (std::shared_ptr<NPC> other : array) {
-                    if (other != npc && npc->is_alive() && other->is_alive()) {
-                        if (npc->is_close(other, DISTANCE)) {
-                            FightManager::get().add_event({npc, other});
-                        }
-                    }
-                }
-            }
-            std::this_thread::sleep_for(1s);
-            ++count;
-        }
-    });
+    print_entities(std::cout, world, true);
+    print_entities(log_file, world, true);
+    std::cout << std::flush; // дальше кадры пишутся в fd 1 мимо буфера cout
+    game_log.log(log_file.str());
 
-    int now = 0, end = 30; 
-    while (now < end && m) {
-        const int grid{20}, step_x{MAX_X / grid}, step_y{MAX_Y / grid};
-        std::array<char, grid * grid> fields{0};
-        std::array<std::string, grid * grid> names{""};
-        
-        // Собираем информацию о NPC на карте
-        for (std::shared_ptr<NPC> npc : array) {
-            auto [x, y] = npc->position();
-            int i = std::min(x / step_x, grid - 1);
-            int j = std::min(y / step_y, grid - 1);
-            
-            int index = i + grid * j;
-            
-            if (npc->is_alive()) {
-                switch (npc->get_type()) {
-                    case KnightType:
-                        fields[index] = 'K';
-                        names[index] = npc->get_name();
-                        break;
-                    case OrcType:
-                        fields[index] = 'O';
-                        names[index] = npc->get_name();
-                        break;
-                    case BearType:
-                        fields[index] = 'B';
-                        names[index] = npc->get_name();
-                        break;
-                    default:
-                        break;
-                }
-            } else {
-                fields[index] = 'X'; // Мертвые NPC
-                names[index] = "DEAD";
-            }
-        }
+    sim.events().subscribe(std::make_shared<ConsoleObserver>(console_mutex), FightFilter::WinsOnly);
+    sim.events().subscribe(std::make_shared<FileObserver>("battle_log.txt"), FightFilter::WinsOnly);
 
-        if(count > 25) {
-            break;
-        }
-        
-        // Вывод в консоль
-        {
-            std::lock_guard<std::mutex> lck(console_mutex);
-            std::cout << "\n=== Turn " << std::setw(2) << now << " ===" << std::endl;
-            std::cout << "Legend: K=Knight, O=Orc, B=Bear, X=Dead" << std::endl;
-            
-            for (int j = 0; j < grid; ++j) {
-                for (int i = 0; i < grid; ++i) {
-                    int index = i + j * grid;
-                    char c = fields[index];
-                    std::string name = names[index];
-                    
-                    if (c != 0) {
-                        std::cout << "[" << c;
-                        if (!name.empty() && name != "DEAD") {
-                            std::cout << name.substr(0, 3); // Показываем первые 3 буквы имени
-                        } else if (name == "DEAD") {
-                            std::cout << "XXX";
-                        } else {
-                            std::cout << "   ";
-                        }
-                        std::cout << "]";
-                    } else {
-                        std::cout << "[    ]";
-                    }
-                }
-                std::cout << std::endl;
-            }
-            
-            // Вывод статистики
-            int knights = 0, orcs = 0, bears = 0, dead = 0;
-            for (auto& npc : array) {
-                if (npc->is_alive()) {
-                    switch(npc->get_type()) {
-                        case KnightType: knights++; break;
-                        case OrcType: orcs++; break;
-                        case BearType: bears++; break;
-                    }
-                } else {
-                    dead++;
-                }
-            }
-            
-            std::cout << "\nStatistics: Knights: " << knights 
-                      << ", Orcs: " << orcs 
-                      << ", Bears: " << bears 
-                      << ", Dead: " << dead 
-                      << ", Total: " << array.size() 
-                      << std::endl;
-        }
-        
-        // Вывод в файл
-        {
-            std::lock_guard<std::mutex> lck(file_mutex);
-            log_file << "\n=== Turn " << std::setw(2) << now << " ===" << std::endl;
-            for (int j = 0; j < grid; ++j) {
-                for (int i = 0; i < grid; ++i) {
-                    int index = i + j * grid;
-                    char c = fields[index];
-                    if (c != 0)
-                        log_file << "[" << c << "]";
-                    else
-                        log_file << "[ ]";
-                }
-                log_file << std::endl;
-            }
-        }
-        
-        std::this_thread::sleep_for(2s); 
-        now += 1;
-    }
+    TickScheduler scheduler(tick_rate);
+    sim.attach(scheduler);
+    watch_metrics_requests(scheduler, metrics_path);
+
+    // Кадр копируется в потоке симуляции, форматирует и пишет его фоновый поток
+    FrameRenderer renderer(game.render_grid, STDOUT_FILENO, console_mutex, &game_log);
+    scheduler.on(TickPhase::Render, [&renderer, &world](size_t now) {
+        std::shared_lock lock(world.mutex()); // поток боёв пишет флаги жизни
+        renderer.capture(world, now);
+    });
 
-    k = false; m = false;
-    move_thread.join();
-    fight_thread.join();
+    scheduler.run(config.ticks);
+    sim.finish();
+    renderer.flush();
+    SimulationResult result = sim.summary();
 
     // Финальный вывод
+    log_file.str("");
     std::cout << "\n\n=== FINAL RESULTS ===" << std::endl;
     log_file << "\n\n=== FINAL RESULTS ===" << std::endl;
     
-    int alive_count = 0;
-    int knights = 0, orcs = 0, bears = 0;
+    size_t alive_count = result.knights + result.orcs + result.bears;
+    size_t knights = result.knights, orcs = result.orcs, bears = result.bears;
     
     std::cout << "\nSurvivors:" << std::endl;
     log_file << "\nSurvivors:" << std::endl;
-    
-    for (auto &n : array) {
-        if (n->is_alive()) {
-            alive_count++;
-            switch(n->get_type()) {
-                case KnightType: knights++; break;
-                case OrcType: orcs++; break;
-                case BearType: bears++; break;
-            }
-            n->print();
-            n->print(log_file);
-        }
-    }
+    print_entities(std::cout, world, true);
+    print_entities(log_file, world, true);
     
     std::cout << "\nDead NPCs:" << std::endl;
     log_file << "\nDead NPCs:" << std::endl;
-    
-    for (auto &n : array) {
-        if (!n->is_alive()) {
-            std::cout << "DEAD - ";
-            n->print();
-            log_file << "DEAD - ";
-            n->print(log_file);
-        }
-    }
+    print_entities(std::cout, world, false, "DEAD - ");
+    print_entities(log_file, world, false, "DEAD - ");
     
     std::cout << "\n=== Summary ===" << std::endl;
     std::cout << "Total survivors: " << alive_count << std::endl;
     std::cout << "Knights: " << knights << std::endl;
     std::cout << "Orcs: " << orcs << std::endl;
     std::cout << "Bears: " << bears << std::endl;
-    std::cout << "Total dead: " << (array.size() - alive_count) << std::endl;
+    std::cout << "Total dead: " << result.dead << std::endl;
     
     log_file << "\n=== Summary ===" << std::endl;
     log_file << "Total survivors: " << alive_count << std::endl;
     log_file << "Knights: " << knights << std::endl;
     log_file << "Orcs: " << orcs << std::endl;
     log_file << "Bears: " << bears << std::endl;
-    log_file << "Total dead: " << (array.size() - alive_count) << std::endl;
+    log_file << "Total dead: " << result.dead << std::endl;
     
     std::cout << "\n=== Game End ===" << std::endl;
     log_file << "\n=== Game End ===" << std::endl;
     
-    log_file.close();
+    game_log.log(log_file.str());
+    game_log.flush();
+
+    if (!save_path.empty() && save_world(world, save_path))
+        std::cout << "\nWorld saved to " << save_path << std::endl;
+    if (!history_path.empty() && save_history(sim.history(), history_path))
+        std::cout << "Population history saved to " << history_path << std::endl;
+    if (!metrics_path.empty() && save_metrics(metrics_path))
+        std::cout << "Metrics saved to " << metrics_path << std::endl;
     
     // Краткий итог победителя
     std::cout << "\n=== WINNER ===" << std::endl;
@@ -443,4 +467,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,136 @@
+#include "../include/async_logger.h"
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    std::atomic<std::uint64_t> next_logger_id{1};
+}
+
+AsyncLogger::AsyncLogger(const std::string &path, bool append,
+                         std::chrono::milliseconds flush_interval, size_t flush_bytes)
+    : id(next_logger_id++), token(std::make_shared<const std::uint64_t>(id)),
+      interval(flush_interval), threshold(flush_bytes) {
+    int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+    fd = ::open(path.c_str(), flags, 0644);
+    writer = std::thread(&AsyncLogger::writer_loop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mtx);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    if (fd >= 0)
+        ::close(fd);
+}
+
+std::vector<AsyncLogger::CacheEntry> &AsyncLogger::thread_cache() {
+    thread_local std::vector<CacheEntry> cache;
+    return cache;
+}
+
+size_t AsyncLogger::thread_cache_size() {
+    return thread_cache().size();
+}
+
+AsyncLogger::ThreadBuffer &AsyncLogger::local_buffer() {
+    // Кэш буферов потока; по уникальному id журнала, а не по адресу,
+    // чтобы новый журнал по старому адресу не взял чужой буфер
+    auto &cache = thread_cache();
+    for (auto &entry : cache)
+        if (entry.logger == id)
+            return *entry.buffer;
+
+    // Буферы удалённых журналов уходят при первой новой записи, иначе
+    // долгоживущий поток копил бы их и удлинял поиск
+    std::erase_if(cache, [](const CacheEntry &entry) { return entry.owner.expired(); });
+    auto buffer = std::make_shared<ThreadBuffer>();
+    {
+        std::lock_guard<std::mutex> lock(registry_mtx);
+        buffers.push_back(buffer);
+    }
+    cache.push_back({id, token, buffer});
+    return *buffer;
+}
+
+void AsyncLogger::log(std::string_view record) {
+    auto &buffer = local_buffer();
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mtx);
+        buffer.data.append(record);
+        size = buffer.data.size();
+    }
+    if (size >= threshold) {
+        {
+            std::lock_guard<std::mutex> lock(writer_mtx);
+            urgent = true;
+        }
+        wake.notify_one();
+    }
+}
+
+void AsyncLogger::flush() {
+    std::unique_lock<std::mutex> lock(writer_mtx);
+    std::uint64_t ticket = ++flush_requested;
+    wake.notify_one();
+    flushed.wait(lock, [this, ticket] { return flush_done >= ticket || stopping; });
+}
+
+bool AsyncLogger::write_pending(std::string &batch) {
+    batch.clear();
+    {
+        std::lock_guard<std::mutex> lock(registry_mtx);
+        for (auto &buffer : buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mtx);
+            batch.append(buffer->data);
+            buffer->data.clear();
+        }
+    }
+    if (batch.empty() || fd < 0)
+        return false;
+
+    const char *data = batch.data();
+    size_t left = batch.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, data, left);
+        if (n <= 0)
+            break;
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+    written += batch.size() - left;
+    ++writes;
+    return true;
+}
+
+void AsyncLogger::writer_loop() {
+    std::string batch;
+    for (;;) {
+        std::uint64_t ticket;
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(writer_mtx);
+            wake.wait_for(lock, interval, [this] {
+                return stopping || urgent || flush_requested != flush_done;
+            });
+            urgent = false;
+            ticket = flush_requested;
+            stop = stopping;
+        }
+
+        write_pending(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(writer_mtx);
+            flush_done = ticket;
+        }
+        flushed.notify_all();
+
+        if (stop)
+            return;
+    }
+}
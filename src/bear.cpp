@@ -4,6 +4,7 @@
 
 Bear::Bear(int x, int y, const std::string& name) : NPC(BearType, x, y, name) {}
 Bear::Bear(std::istream &is) : NPC(BearType, is) {}
+Bear::Bear(World &world, EntityId id) : NPC(BearType, world, id) {}
 
 void Bear::print() {
     std::cout << *this;
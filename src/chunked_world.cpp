@@ -0,0 +1,346 @@
+#include "../include/chunked_world.h"
+#include "../include/snapshot.h"
+#include "../include/rng.h"
+#include "../include/metrics.h"
+#include "../include/npc_registry.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <unistd.h>
+
+ChunkedWorld::ChunkedWorld(const SimulationConfig &config, ChunkConfig chunks)
+    : width(config.max_x), height(config.max_y), sim_cfg(config), cfg(std::move(chunks)) {
+    cfg.chunk_size = std::max(cfg.chunk_size, 1);
+    if (cfg.page_dir.empty()) {
+        static std::atomic<unsigned> instances{0};
+        auto dir = std::filesystem::temp_directory_path()
+            / ("lab7_chunks_" + std::to_string(::getpid()) + "_" + std::to_string(instances++));
+        cfg.page_dir = dir.string();
+        own_dir = true;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(cfg.page_dir, ec);
+    if (ec)
+        std::cerr << "cannot create chunk directory: " << cfg.page_dir << ": " << ec.message() << std::endl;
+}
+
+ChunkedWorld::~ChunkedWorld() {
+    std::error_code ec;
+    if (own_dir) {
+        std::filesystem::remove_all(cfg.page_dir, ec);
+        return;
+    }
+    for (auto &[key, chunk] : chunks) {
+        if (!chunk.sim)
+            std::filesystem::remove(path_of(key), ec);
+    }
+}
+
+std::uint64_t ChunkedWorld::key_of(int x, int y) const {
+    auto cx = static_cast<std::uint32_t>(std::clamp(x, 0, std::max(width, 0)) / cfg.chunk_size);
+    auto cy = static_cast<std::uint32_t>(std::clamp(y, 0, std::max(height, 0)) / cfg.chunk_size);
+    return (static_cast<std::uint64_t>(cy) << 32) | cx;
+}
+
+std::string ChunkedWorld::path_of(std::uint64_t key) const {
+    return cfg.page_dir + "/chunk_" + std::to_string(key & 0xffffffffu) + "_" + std::to_string(key >> 32) + ".l7ws";
+}
+
+MapArea ChunkedWorld::area_of(std::uint64_t key) const {
+    const int cx = static_cast<int>(key & 0xffffffffu) * cfg.chunk_size;
+    const int cy = static_cast<int>(key >> 32) * cfg.chunk_size;
+    return {cx, cy, std::min(cx + cfg.chunk_size - 1, width), std::min(cy + cfg.chunk_size - 1, height)};
+}
+
+std::unique_ptr<Simulation> ChunkedWorld::make_chunk(std::uint64_t key, std::unique_ptr<World> world) const {
+    // Чанк ведёт только ходы и бои своих NPC
+    SimulationConfig config = sim_cfg;
+    config.seed = sim_cfg.seed ^ CounterRng::mix(key);
+    config.population = {0, 0, 0};
+    config.spawn_rates.clear();
+    config.fight_workers = 1;
+    config.fight_thread = false;
+    config.history_ticks = 1;
+    // Границы мира - всей карты: ход у края чанка уводит в соседа, а не упирается
+    if (!world)
+        world = std::make_unique<World>(width, height);
+    return std::make_unique<Simulation>(config, std::move(world), area_of(key));
+}
+
+void ChunkedWorld::account(Chunk &chunk) {
+    size_t bytes = chunk.sim->get_world().memory_bytes();
+    resident_bytes = resident_bytes - chunk.bytes + bytes;
+    chunk.bytes = bytes;
+}
+
+void ChunkedWorld::retire(Chunk &chunk) {
+    retired_dead += chunk.sim->get_world().dead_count();
+    lru.erase(chunk.lru);
+    resident_bytes -= chunk.bytes;
+    chunk.bytes = 0;
+}
+
+Simulation *ChunkedWorld::use(std::uint64_t key, bool create) {
+    auto it = chunks.find(key);
+    if (it == chunks.end()) {
+        if (!create)
+            return nullptr;
+        it = chunks.emplace(key, Chunk{}).first;
+        it->second.sim = make_chunk(key, nullptr);
+        lru.push_front(key);
+        it->second.lru = lru.begin();
+        account(it->second);
+    } else if (!it->second.sim) {
+        std::unique_ptr<World> loaded;
+        {
+            LAB7_TIME(MetricTimer::PageIn);
+            loaded = load_snapshot(path_of(key));
+        }
+        if (!loaded)
+            return nullptr; // причину уже напечатал load_snapshot, файл остаётся
+        std::error_code ec;
+        std::filesystem::remove(path_of(key), ec);
+        it->second.sim = make_chunk(key, std::move(loaded));
+        it->second.paged = {};
+        lru.push_front(key);
+        it->second.lru = lru.begin();
+        account(it->second);
+        ++page_ins;
+        LAB7_COUNT(ChunksPagedIn, 1);
+    } else {
+        lru.splice(lru.begin(), lru, it->second.lru);
+    }
+    it->second.used = epoch;
+    return it->second.sim.get();
+}
+
+bool ChunkedWorld::page_out(std::uint64_t key, Chunk &chunk) {
+    const World *world = &chunk.sim->get_world();
+    {
+        LAB7_TIME(MetricTimer::PageOut);
+        // На диск - только живые, без дыр от похороненных и ушедших к соседям
+        World packed(width, height);
+        if (world->free_slots() > 0) {
+            packed.reserve(world->live_ids().size());
+            for (EntityId id : world->live_ids()) {
+                if (world->is_alive(id))
+                    packed.spawn(world->type(id), world->x(id), world->y(id), world->name(id));
+            }
+            world = &packed;
+        }
+        if (!save_snapshot(*world, path_of(key)))
+            return false;
+        chunk.paged = world->population();
+        chunk.paged.dead = 0;
+    }
+    retire(chunk);
+    chunk.sim.reset();
+    ++page_outs;
+    LAB7_COUNT(ChunksPagedOut, 1);
+    return true;
+}
+
+void ChunkedWorld::enforce_budget() {
+    while (resident_bytes > cfg.memory_budget && !lru.empty()) {
+        std::uint64_t key = lru.back();
+        Chunk &chunk = chunks.at(key);
+        // Хвост старше всех; если и он нужен текущей операции - выгружать некого
+        if (chunk.used == epoch)
+            break;
+        if (!page_out(key, chunk))
+            break;
+    }
+}
+
+void ChunkedWorld::drop_empty() {
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        Chunk &chunk = it->second;
+        if (chunk.sim && chunk.sim->get_world().population().total_alive() == 0) {
+            retire(chunk);
+            it = chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ChunkedWorld::populate() {
+    place_population(sim_cfg, [this](NpcType type, int x, int y, const std::string &name) {
+        spawn(type, x, y, name);
+    });
+}
+
+bool ChunkedWorld::spawn(NpcType type, int x, int y, std::string_view name) {
+    ++epoch;
+    Simulation *sim = use(key_of(x, y), true);
+    if (!sim)
+        return false;
+    sim->spawn(type, x, y, name);
+    account(chunks.at(key_of(x, y)));
+    enforce_budget();
+    return true;
+}
+
+void ChunkedWorld::touch(int x, int y, int radius) {
+    ++epoch;
+    const long long cx = std::clamp(x, 0, std::max(width, 0)) / cfg.chunk_size;
+    const long long cy = std::clamp(y, 0, std::max(height, 0)) / cfg.chunk_size;
+    const long long last_x = std::max(width, 0) / cfg.chunk_size;
+    const long long last_y = std::max(height, 0) / cfg.chunk_size;
+    for (long long ny = std::max(cy - radius, 0LL); ny <= std::min(cy + radius, last_y); ++ny) {
+        for (long long nx = std::max(cx - radius, 0LL); nx <= std::min(cx + radius, last_x); ++nx)
+            use((static_cast<std::uint64_t>(ny) << 32) | static_cast<std::uint64_t>(nx), false);
+    }
+    enforce_budget();
+}
+
+void ChunkedWorld::resident_keys() {
+    keys.assign(lru.begin(), lru.end());
+    // Порядок чанков задаёт порядок прихода к соседям и боёв на границах -
+    // от LRU он не зависит
+    std::sort(keys.begin(), keys.end());
+}
+
+void ChunkedWorld::tick(size_t tick) {
+    ++epoch;
+    resident_keys();
+    for (std::uint64_t key : keys)
+        chunks.at(key).sim->move_phase(tick);
+
+    // Переход до поиска боёв: дальше каждый NPC лежит в своём чанке
+    migrants.clear();
+    for (std::uint64_t key : keys) {
+        Simulation &sim = *chunks.at(key).sim;
+        const World &world = sim.get_world();
+        for (EntityId id : world.live_ids()) {
+            if (!world.is_alive(id))
+                continue;
+            std::uint64_t to = key_of(world.x(id), world.y(id));
+            if (to == key)
+                continue;
+            migrants.push_back({key, to, world.type(id), world.x(id), world.y(id), std::string(world.name(id))});
+            sim.emigrate(id);
+        }
+    }
+    for (const Migrant &m : migrants) {
+        Simulation *sim = use(m.to, true);
+        // Соседа не удалось загрузить - остаётся дома и попробует снова
+        if (!sim)
+            sim = use(m.from, true);
+        sim->spawn(m.type, m.x, m.y, m.name);
+    }
+
+    resident_keys();
+    for (std::uint64_t key : keys) {
+        Simulation &sim = *chunks.at(key).sim;
+        sim.detect_phase(tick);
+        sim.fight_phase(tick);
+    }
+    border_fights();
+    for (std::uint64_t key : keys)
+        chunks.at(key).sim->end_tick(tick);
+
+    for (std::uint64_t key : lru)
+        account(chunks.at(key));
+    drop_empty();
+    enforce_budget();
+}
+
+void ChunkedWorld::border_fights() {
+    // Половина окрестности, как в SpatialGrid: каждая пара соседей один раз
+    static constexpr int offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    const NpcRegistry &registry = npc_registry();
+    const long long d = sim_cfg.distance;
+
+    // Живые чанка, которые могут дотянуться до области соседа
+    auto collect = [d](const World &world, const MapArea &area, std::vector<EntityId> &out) {
+        out.clear();
+        for (EntityId id : world.live_ids()) {
+            if (world.is_alive(id)
+                && world.x(id) >= area.min_x - d && world.x(id) <= area.max_x + d
+                && world.y(id) >= area.min_y - d && world.y(id) <= area.max_y + d)
+                out.push_back(id);
+        }
+    };
+
+    for (std::uint64_t key : keys) {
+        World &here = chunks.at(key).sim->get_world();
+        const long long cx = static_cast<long long>(key & 0xffffffffu);
+        const long long cy = static_cast<long long>(key >> 32);
+        for (auto &o : offsets) {
+            if (cx + o[0] < 0)
+                continue;
+            std::uint64_t other = (static_cast<std::uint64_t>(cy + o[1]) << 32)
+                                | static_cast<std::uint64_t>(cx + o[0]);
+            auto it = chunks.find(other);
+            // Выгруженный сосед заморожен и в боях не участвует
+            if (it == chunks.end() || !it->second.sim)
+                continue;
+            World &there = it->second.sim->get_world();
+            collect(here, area_of(other), halo_here);
+            if (halo_here.empty())
+                continue;
+            collect(there, area_of(key), halo_there);
+
+            for (EntityId a : halo_here) {
+                for (EntityId b : halo_there) {
+                    if (!here.is_alive(a))
+                        break;
+                    if (!there.is_alive(b))
+                        continue;
+                    long long dx = static_cast<long long>(here.x(a)) - there.x(b);
+                    long long dy = static_cast<long long>(here.y(a)) - there.y(b);
+                    if (dx * dx + dy * dy > d * d)
+                        continue;
+                    LAB7_COUNT(FightsEnqueued, 1);
+                    LAB7_COUNT(FightsResolved, 1);
+                    // Как canonical_fight: атакует победитель, при равенстве - чанк с меньшим ключом
+                    if (registry.wins(here.type(a), there.type(b)))
+                        there.kill(b);
+                    else if (registry.wins(there.type(b), here.type(a)))
+                        here.kill(a);
+                }
+            }
+        }
+    }
+}
+
+const World *ChunkedWorld::resident_chunk(int x, int y) const {
+    auto it = chunks.find(key_of(x, y));
+    return it == chunks.end() || !it->second.sim ? nullptr : &it->second.sim->get_world();
+}
+
+bool ChunkedWorld::is_paged(int x, int y) const {
+    auto it = chunks.find(key_of(x, y));
+    return it != chunks.end() && !it->second.sim;
+}
+
+size_t ChunkedWorld::population() const {
+    return counts().total_alive();
+}
+
+PopulationCounts ChunkedWorld::counts() const {
+    PopulationCounts total;
+    total.dead = retired_dead;
+    for (auto &[key, chunk] : chunks) {
+        PopulationCounts c = chunk.sim ? chunk.sim->get_world().population() : chunk.paged;
+        for (size_t t = 0; t < MAX_NPC_TYPES; ++t)
+            total.alive[t] += c.alive[t];
+        total.dead += c.dead;
+    }
+    return total;
+}
+
+ChunkStats ChunkedWorld::stats() const {
+    ChunkStats s;
+    for (auto &[key, chunk] : chunks) {
+        if (chunk.sim)
+            ++s.resident;
+        else
+            ++s.paged;
+    }
+    s.resident_bytes = resident_bytes;
+    s.page_ins = page_ins;
+    s.page_outs = page_outs;
+    return s;
+}
@@ -0,0 +1,159 @@
+#include "../include/config_file.h"
+#include "../include/npc_registry.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string_view>
+
+namespace {
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+            s.remove_suffix(1);
+        return s;
+    }
+
+    // Целое без хвоста, не меньше min
+    bool parse_int(std::string_view s, long long min, long long &value) {
+        auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc() && end == s.data() + s.size() && value >= min;
+    }
+
+    // Имя типа из реестра; "unknown" - тоже тип
+    bool type_by_name(std::string_view name, NpcType &type) {
+        type = npc_registry().find(name);
+        return type != Unknown || name == "unknown" || name == "Unknown";
+    }
+
+    bool apply(GameConfig &config, std::string_view key, std::string_view value) {
+        SimulationConfig &sim = config.sim;
+        if (key == "map")
+            return parse_map_size(std::string(value), sim.max_x, sim.max_y);
+
+        // Ключ -> поле и нижняя граница значения
+        struct IntKey {
+            std::string_view name;
+            long long min;
+            int *field;
+        };
+        const IntKey int_keys[] = {
+            {"map_x", 1, &sim.max_x},
+            {"map_y", 1, &sim.max_y},
+            {"kill_distance", 1, &sim.distance},
+            {"render_grid", 1, &config.render_grid},
+        };
+        long long v = 0;
+        NpcType type = Unknown;
+        if (key.starts_with("move.")) {
+            if (!type_by_name(key.substr(5), type) || !parse_int(value, 0, v) || v > std::numeric_limits<int>::max())
+                return false;
+            // Незаданные в файле типы сохраняют шаг из реестра
+            if (sim.move_ranges.empty())
+                sim.move_ranges = npc_registry().move_ranges();
+            if (sim.move_ranges.size() <= static_cast<size_t>(type))
+                sim.move_ranges.resize(static_cast<size_t>(type) + 1, 0);
+            sim.move_ranges[type] = static_cast<int>(v);
+            return true;
+        }
+        if (key.starts_with("rate.")) {
+            double rate = 0;
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), rate);
+            if (!type_by_name(key.substr(5), type) || type == Unknown || ec != std::errc()
+                || end != value.data() + value.size() || !(rate >= 0))
+                return false;
+            auto it = std::find_if(sim.spawn_rates.begin(), sim.spawn_rates.end(),
+                                   [type](const SpawnRate &r) { return r.type == type; });
+            if (it == sim.spawn_rates.end())
+                sim.spawn_rates.push_back({type, rate});
+            else
+                it->per_tick = rate;
+            return true;
+        }
+        if (key.starts_with("spawn.")) {
+            if (!type_by_name(key.substr(6), type) || type == Unknown || !parse_int(value, 0, v))
+                return false;
+            sim.population.set(type, static_cast<size_t>(v));
+            return true;
+        }
+
+        for (const auto &k : int_keys) {
+            if (key != k.name)
+                continue;
+            if (!parse_int(value, k.min, v) || v > std::numeric_limits<int>::max())
+                return false;
+            *k.field = static_cast<int>(v);
+            return true;
+        }
+
+        const std::pair<std::string_view, size_t *> size_keys[] = {
+            {"ticks", &sim.ticks},
+            {"population_cap", &sim.population_cap},
+            {"orcs", &sim.population.orcs},
+            {"knights", &sim.population.knights},
+            {"bears", &sim.population.bears},
+        };
+        for (const auto &[name, field] : size_keys) {
+            if (key != name)
+                continue;
+            if (!parse_int(value, 0, v))
+                return false;
+            *field = static_cast<size_t>(v);
+            return true;
+        }
+        return false;
+    }
+}
+
+bool parse_config(std::istream &is, GameConfig &config, const std::string &origin) {
+    std::string line;
+    for (size_t number = 1; std::getline(is, line); ++number) {
+        std::string_view text(line);
+        text = trim(text.substr(0, text.find('#')));
+        if (text.empty())
+            continue;
+        size_t eq = text.find('=');
+        if (eq == std::string_view::npos) {
+            std::cerr << origin << ":" << number << ": expected key = value" << std::endl;
+            return false;
+        }
+        std::string_view key = trim(text.substr(0, eq));
+        std::string_view value = trim(text.substr(eq + 1));
+        if (!apply(config, key, value)) {
+            std::cerr << origin << ":" << number << ": bad value or unknown key: " << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool load_config(const std::string &path, GameConfig &config) {
+    std::ifstream is(path);
+    if (!is) {
+        std::cerr << "cannot open config: " << path << std::endl;
+        return false;
+    }
+    return parse_config(is, config, path);
+}
+
+bool parse_map_size(const std::string &arg, int &max_x, int &max_y) {
+    int w = 0, h = 0;
+    char sep = 0;
+    std::istringstream is(arg);
+    if (!(is >> w) || w <= 0)
+        return false;
+    if (!(is >> sep)) {
+        max_x = max_y = w;
+        return true;
+    }
+    if (sep != 'x' || !(is >> h) || h <= 0)
+        return false;
+    // Хвост после WxH - ошибка, как и у остальных ключей
+    if (!(is >> std::ws).eof())
+        return false;
+    max_x = w;
+    max_y = h;
+    return true;
+}
@@ -0,0 +1,42 @@
+#include "../include/event_bus.h"
+
+void EventBus::subscribe(std::shared_ptr<IFightBatchObserver> observer, FightFilter filter) {
+    if (filter == FightFilter::WinsOnly)
+        win_observers.push_back(std::move(observer));
+    else
+        all_observers.push_back(std::move(observer));
+}
+
+void EventBus::publish(const FightRecord &record) {
+    std::lock_guard<std::mutex> lock(mtx);
+    records.push_back(record);
+}
+
+size_t EventBus::pending() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return records.size();
+}
+
+size_t EventBus::dispatch(const World &world) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        batch.swap(records);
+        records.clear();
+    }
+    if (batch.empty())
+        return 0;
+
+    for (auto &o : all_observers)
+        o->on_fights(world, batch);
+
+    if (!win_observers.empty()) {
+        wins.clear();
+        for (auto &record : batch)
+            if (record.win)
+                wins.push_back(record);
+        if (!wins.empty())
+            for (auto &o : win_observers)
+                o->on_fights(world, wins);
+    }
+    return batch.size();
+}
@@ -0,0 +1,52 @@
+#include "../include/factory.h"
+#include "../include/orc.h"
+#include "../include/knight.h"
+#include "../include/bear.h"
+
+std::shared_ptr<NPC> factory(std::istream &is) {
+    std::shared_ptr<NPC> result;
+    int type{0};
+    if (is >> type) {
+        switch (type)
+        {
+        case OrcType:
+            result = std::make_shared<Orc>(is);
+            break;
+        case KnightType:
+            result = std::make_shared<Knight>(is);
+            break;
+        case BearType:
+            result = std::make_shared<Bear>(is);
+            break;
+        }
+    }
+    else
+        std::cerr << "unexpected NPC type:" << type << std::endl;
+
+    return result;
+}
+
+std::shared_ptr<NPC> factory(World &world, EntityId id) {
+    std::shared_ptr<NPC> result;
+    switch (world.type(id))
+    {
+    case OrcType:
+        result = std::make_shared<Orc>(world, id);
+        break;
+    case KnightType:
+        result = std::make_shared<Knight>(world, id);
+        break;
+    case BearType:
+        result = std::make_shared<Bear>(world, id);
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+std::shared_ptr<NPC> factory(World &world, NpcType type, int x, int y) {
+    if (type < OrcType || type > BearType)
+        return nullptr;
+    return factory(world, world.spawn(type, x, y));
+}
@@ -0,0 +1,96 @@
+#include "../include/fight_candidates.h"
+#include "../include/npc_registry.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+FightPair canonical_fight(const World &world, EntityId a, EntityId b) {
+    const NpcRegistry &registry = npc_registry();
+    bool a_wins = registry.wins(world.type(a), world.type(b));
+    bool b_wins = registry.wins(world.type(b), world.type(a));
+    if (a_wins != b_wins)
+        return a_wins ? FightPair{a, b} : FightPair{b, a};
+    return {std::min(a, b), std::max(a, b)};
+}
+
+InFlightPairs::InFlightPairs(size_t capacity) {
+    size_t per_shard = std::max<size_t>((capacity + SHARDS - 1) / SHARDS, 1);
+    shard_capacity = std::bit_ceil(per_shard * 2);
+    shard_limit = shard_capacity / 2;
+    for (auto &shard : shards)
+        shard.slots = std::make_unique<Key[]>(shard_capacity);
+}
+
+InFlightPairs::Key InFlightPairs::key_of(EntityHandle a, EntityHandle b) {
+    if (b.id < a.id)
+        std::swap(a, b);
+    auto pack = [](EntityHandle h) { return (std::uint64_t(h.generation) << 32) | h.id; };
+    // a.id < b.id, поэтому a.id < 2^32 - 1 и first не переполняется в 0
+    return {pack(a) + 1, pack(b)};
+}
+
+std::uint64_t InFlightPairs::hash(const Key &key) {
+    std::uint64_t h = key.first ^ (key.second * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+InFlightPairs::Insert InFlightPairs::insert(EntityHandle a, EntityHandle b) {
+    Key key = key_of(a, b);
+    std::uint64_t h = hash(key);
+    Shard &shard = shards[h % SHARDS];
+    const size_t mask = shard_capacity - 1;
+
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    for (size_t i = (h / SHARDS) & mask;; i = (i + 1) & mask) {
+        if (shard.slots[i] == key)
+            return Insert::Duplicate;
+        if (shard.slots[i].first == 0)
+            break;
+    }
+    if (shard.used >= shard_limit)
+        return Insert::Full;
+    size_t i = (h / SHARDS) & mask;
+    while (shard.slots[i].first != 0)
+        i = (i + 1) & mask;
+    shard.slots[i] = key;
+    ++shard.used;
+    return Insert::Added;
+}
+
+void InFlightPairs::erase(EntityHandle a, EntityHandle b) {
+    Key key = key_of(a, b);
+    std::uint64_t h = hash(key);
+    Shard &shard = shards[h % SHARDS];
+    const size_t mask = shard_capacity - 1;
+
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    size_t i = (h / SHARDS) & mask;
+    while (shard.slots[i] != key) {
+        if (shard.slots[i].first == 0)
+            return;
+        i = (i + 1) & mask;
+    }
+    // Удаление со сдвигом назад: цепочки проб остаются без дыр и надгробий
+    for (size_t j = (i + 1) & mask; shard.slots[j].first != 0; j = (j + 1) & mask) {
+        size_t home = (hash(shard.slots[j]) / SHARDS) & mask;
+        // Элемент j можно перенести в дыру i, если его место не в (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            shard.slots[i] = shard.slots[j];
+            i = j;
+        }
+    }
+    shard.slots[i] = {};
+    --shard.used;
+}
+
+size_t InFlightPairs::size() const {
+    size_t total = 0;
+    for (auto &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        total += shard.used;
+    }
+    return total;
+}
@@ -0,0 +1,181 @@
+#include "../include/fight_manager.h"
+#include "../include/npc_registry.h"
+#include "../include/metrics.h"
+#include <mutex>
+#include <thread>
+
+bool resolve_with_visitor(const std::shared_ptr<NPC> &attacker, const std::shared_ptr<NPC> &defender) {
+    if (attacker->is_alive() && defender->is_alive()) {
+        if (defender->accept(attacker)) {
+            defender->must_die();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool resolve_with_table(const std::shared_ptr<NPC> &attacker, const std::shared_ptr<NPC> &defender) {
+    if (!attacker->is_alive() || !defender->is_alive())
+        return false;
+
+    bool win = npc_registry().wins(attacker->get_type(), defender->get_type());
+    attacker->fight_notify(defender, win);
+    if (win)
+        defender->must_die();
+    return win;
+}
+
+bool resolve_in_world(World &world, const FightEvent &event, EventBus *bus) {
+    if (!world.is_valid(event.attacker) || !world.is_valid(event.defender)) {
+        LAB7_COUNT(FightsSkippedDead, 1);
+        return false;
+    }
+    EntityId attacker = event.attacker.id;
+    EntityId defender = event.defender.id;
+    if (!world.is_alive(attacker) || !world.is_alive(defender)) {
+        LAB7_COUNT(FightsSkippedDead, 1);
+        return false;
+    }
+    LAB7_COUNT(FightsResolved, 1);
+
+    NpcType attacker_type = world.type(attacker);
+    NpcType defender_type = world.type(defender);
+    bool win = npc_registry().wins(attacker_type, defender_type);
+    if (win)
+        world.kill(defender);
+    if (bus) {
+        bus->publish({attacker, defender,
+                      static_cast<std::uint8_t>(attacker_type), static_cast<std::uint8_t>(defender_type), win});
+    }
+    return win;
+}
+
+void FightManager::add_event(FightEvent &&event) {
+    LAB7_COUNT(FightsEnqueued, 1);
+    bool waited = false;
+    while (!events.try_push(std::move(event))) {
+        waited = true;
+        std::this_thread::yield();
+    }
+    // Одно событие - одна повторная постановка, сколько бы ни ждало
+    if (waited)
+        LAB7_COUNT(FightsRequeued, 1);
+    ready.notify();
+}
+
+bool FightManager::add_candidate(EntityId a, EntityId b) {
+    EntityHandle ha = world.handle(a), hb = world.handle(b);
+    switch (in_flight.insert(ha, hb)) {
+        case InFlightPairs::Insert::Duplicate:
+            LAB7_COUNT(FightsDeduplicated, 1);
+            return false;
+        case InFlightPairs::Insert::Full:
+            LAB7_COUNT(FightsDropped, 1);
+            return false;
+        case InFlightPairs::Insert::Added:
+            break;
+    }
+    FightPair pair = canonical_fight(world, a, b);
+    FightEvent event{pair.attacker == a ? ha : hb, pair.attacker == a ? hb : ha, true};
+    if (!events.try_push(std::move(event))) {
+        in_flight.erase(ha, hb);
+        LAB7_COUNT(FightsDropped, 1);
+        return false;
+    }
+    LAB7_COUNT(FightsEnqueued, 1);
+    ready.notify();
+    return true;
+}
+
+void FightManager::set_parallel(size_t workers) {
+    if (workers > 1)
+        resolver = std::make_unique<RegionFightResolver>(world, workers);
+    else
+        resolver.reset();
+}
+
+size_t FightManager::resolve_parallel(std::span<FightEvent> batch) {
+    std::unique_lock lck(world.mutex());
+
+    // Устаревшие ссылки отсеиваются до раздачи по регионам
+    std::vector<FightPair> pairs;
+    pairs.reserve(batch.size());
+    for (auto &event : batch) {
+        if (world.is_valid(event.attacker) && world.is_valid(event.defender))
+            pairs.push_back({event.attacker.id, event.defender.id});
+    }
+    LAB7_COUNT(FightsSkippedDead, batch.size() - pairs.size());
+
+    size_t killed = 0;
+    for (auto &outcome : resolver->resolve(pairs)) {
+        auto [attacker, defender] = pairs[outcome.event];
+        if (bus) {
+            bus->publish({attacker, defender,
+                          static_cast<std::uint8_t>(world.type(attacker)),
+                          static_cast<std::uint8_t>(world.type(defender)), outcome.win});
+        }
+        if (outcome.win)
+            ++killed;
+    }
+    return killed;
+}
+
+size_t FightManager::resolve_batch(std::span<FightEvent> batch) {
+    LAB7_TIME(MetricTimer::FightBatch);
+    if (resolver)
+        return resolve_parallel(batch);
+
+    std::unique_lock lck(world.mutex());
+    size_t killed = 0;
+    for (auto &event : batch) {
+        if (resolve_in_world(world, event, bus))
+            ++killed;
+    }
+    return killed;
+}
+
+size_t FightManager::pop_batch(std::vector<FightEvent> &batch) {
+    batch.clear();
+    FightEvent event;
+    while (events.try_pop(event))
+        batch.push_back(event);
+    return batch.size();
+}
+
+size_t FightManager::finish_batch(std::span<FightEvent> batch) {
+    size_t killed = resolve_batch(batch);
+    // События add_event в таблице не числятся: их пара могла совпасть с
+    // кандидатом, который ещё ждёт в очереди
+    for (auto &event : batch) {
+        if (event.candidate)
+            in_flight.erase(event.attacker, event.defender);
+    }
+    return killed;
+}
+
+size_t FightManager::drain() {
+    std::vector<FightEvent> batch;
+    pop_batch(batch);
+    return finish_batch(batch);
+}
+
+void FightManager::stop() {
+    running = false;
+    ready.notify_all();
+}
+
+void FightManager::operator()() {
+    std::vector<FightEvent> batch;
+    while (running) {
+        if (pop_batch(batch)) {
+            finish_batch(batch);
+            continue;
+        }
+        auto key = ready.prepare_wait();
+        if (!events.empty() || !running) {
+            ready.cancel_wait();
+            continue;
+        }
+        ready.wait(key);
+    }
+}
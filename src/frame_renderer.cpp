@@ -0,0 +1,203 @@
+#include "../include/frame_renderer.h"
+#include "../include/async_logger.h"
+#include "../include/npc_registry.h"
+#include "../include/metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <unistd.h>
+
+namespace {
+    void append_number(std::string &out, size_t value, int width = 0) {
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        for (int pad = width - static_cast<int>(end - digits); pad > 0; --pad)
+            out.push_back(' ');
+        out.append(digits, end);
+    }
+}
+
+FrameRenderer::FrameRenderer(int grid_size, int out_fd, std::mutex &console, AsyncLogger *game_log)
+    : grid(std::max(grid_size, 1)), fd(out_fd), console_mutex(console), log(game_log) {
+    size_t cells = static_cast<size_t>(grid) * grid;
+    back.cells.resize(cells);
+    ready.cells.resize(cells);
+    front.cells.resize(cells);
+    // "[Xabc]" на клетку плюс заголовок и статистика
+    text.reserve(cells * 6 + grid + 256);
+    log_text.reserve(cells * 3 + grid + 64);
+    writer = std::thread(&FrameRenderer::writer_loop, this);
+}
+
+FrameRenderer::~FrameRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void FrameRenderer::capture(const World &world, size_t tick) {
+    const int step_x = std::max(world.max_x() / grid, 1);
+    const int step_y = std::max(world.max_y() / grid, 1);
+
+    back.tick = tick;
+    back.total = world.size();
+    back.stats = world.population();
+    std::fill(back.cells.begin(), back.cells.end(), RenderCell{0, 0, {}});
+    // Убитые за такт ещё в live_ids() и рисуются крестом, compact() идёт после
+    for (EntityId id : world.live_ids()) {
+        int i = std::min(world.x(id) / step_x, grid - 1);
+        int j = std::min(world.y(id) / step_y, grid - 1);
+        RenderCell &cell = back.cells[i + grid * j];
+
+        if (world.is_alive(id)) {
+            char glyph = npc_registry().glyph(world.type(id));
+            if (glyph == 0)
+                continue;
+            std::string_view name = world.name(id);
+            cell.glyph = glyph;
+            cell.name_len = static_cast<std::uint8_t>(std::min<size_t>(name.size(), 3));
+            std::copy_n(name.data(), cell.name_len, cell.name);
+        } else {
+            cell.glyph = 'X'; // Мертвые NPC
+            cell.name_len = 0;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::swap(back, ready);
+        if (has_ready)
+            ++dropped;
+        has_ready = true;
+    }
+    wake.notify_one();
+}
+
+void FrameRenderer::flush() {
+    std::unique_lock<std::mutex> lock(mtx);
+    drawn.wait(lock, [this] { return (!has_ready && !drawing) || stopping; });
+}
+
+size_t FrameRenderer::frames_written() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return written;
+}
+
+size_t FrameRenderer::frames_dropped() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped;
+}
+
+size_t FrameRenderer::write_calls() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return writes;
+}
+
+void FrameRenderer::format_console(const RenderFrame &frame, int grid, std::string &out) {
+    out += "\n=== Turn ";
+    append_number(out, frame.tick, 2);
+    out += " ===\nLegend: K=Knight, O=Orc, B=Bear, X=Dead\n";
+    for (int j = 0; j < grid; ++j) {
+        for (int i = 0; i < grid; ++i) {
+            const RenderCell &cell = frame.cells[i + j * grid];
+            if (cell.glyph == 0) {
+                out += "[    ]";
+                continue;
+            }
+            out.push_back('[');
+            out.push_back(cell.glyph);
+            if (cell.glyph == 'X')
+                out += "XXX";
+            else
+                out.append(cell.name, cell.name_len); // первые 3 буквы имени
+            out.push_back(']');
+        }
+        out.push_back('\n');
+    }
+    out += "\nStatistics: Knights: ";
+    append_number(out, frame.stats.of(KnightType));
+    out += ", Orcs: ";
+    append_number(out, frame.stats.of(OrcType));
+    out += ", Bears: ";
+    append_number(out, frame.stats.of(BearType));
+    out += ", Dead: ";
+    append_number(out, frame.stats.dead);
+    out += ", Total: ";
+    append_number(out, frame.total);
+    out.push_back('\n');
+}
+
+void FrameRenderer::format_log(const RenderFrame &frame, int grid, std::string &out) {
+    out += "\n=== Turn ";
+    append_number(out, frame.tick, 2);
+    out += " ===\n";
+    for (int j = 0; j < grid; ++j) {
+        for (int i = 0; i < grid; ++i) {
+            char c = frame.cells[i + j * grid].glyph;
+            out.push_back('[');
+            out.push_back(c != 0 ? c : ' ');
+            out.push_back(']');
+        }
+        out.push_back('\n');
+    }
+}
+
+size_t FrameRenderer::write_all(const std::string &data) {
+    // Обычно один вызов; повтор при частичной записи в пайп и при
+    // прерывании сигналом (SIGUSR1 отчёта метрик)
+    const char *p = data.data();
+    size_t left = data.size();
+    size_t calls = 0;
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        ++calls;
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    return calls;
+}
+
+void FrameRenderer::writer_loop() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wake.wait(lock, [this] { return stopping || has_ready; });
+            if (!has_ready)
+                return; // остановка, всё выведено
+            std::swap(ready, front);
+            has_ready = false;
+            drawing = true;
+        }
+
+        size_t calls;
+        {
+            LAB7_TIME(MetricTimer::FrameWrite);
+            text.clear();
+            format_console(front, grid, text);
+            {
+                std::lock_guard<std::mutex> lock(console_mutex);
+                calls = write_all(text);
+            }
+            if (log) {
+                log_text.clear();
+                format_log(front, grid, log_text);
+                log->log(log_text);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            drawing = false;
+            ++written;
+            writes += calls;
+        }
+        drawn.notify_all();
+    }
+}
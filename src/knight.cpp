@@ -4,6 +4,7 @@
 
 Knight::Knight(int x, int y, const std::string& name) : NPC(KnightType, x, y, name) {}
 Knight::Knight(std::istream &is) : NPC(KnightType, is) {}
+Knight::Knight(World &world, EntityId id) : NPC(KnightType, world, id) {}
 
 void Knight::print() {
     std::cout << *this;
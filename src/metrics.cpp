@@ -0,0 +1,134 @@
+#include "../include/metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <ostream>
+
+const char *metric_name(MetricCounter counter) {
+    switch (counter) {
+        case MetricCounter::FightsEnqueued: return "fights_enqueued";
+        case MetricCounter::FightsResolved: return "fights_resolved";
+        case MetricCounter::FightsSkippedDead: return "fights_skipped_dead";
+        case MetricCounter::FightsRequeued: return "fights_requeued";
+        case MetricCounter::FightsDeduplicated: return "fights_deduplicated";
+        case MetricCounter::FightsDropped: return "fights_dropped";
+        case MetricCounter::NpcsBuried: return "npcs_buried";
+        case MetricCounter::NpcsSpawned: return "npcs_spawned";
+        case MetricCounter::ChunksPagedIn: return "chunks_paged_in";
+        case MetricCounter::ChunksPagedOut: return "chunks_paged_out";
+        default: return "unknown";
+    }
+}
+
+const char *metric_name(MetricTimer timer) {
+    switch (timer) {
+        case MetricTimer::Move: return "move";
+        case MetricTimer::Detect: return "detect";
+        case MetricTimer::Fight: return "fight";
+        case MetricTimer::Observe: return "observe";
+        case MetricTimer::Render: return "render";
+        case MetricTimer::Compact: return "compact";
+        case MetricTimer::Spawn: return "spawn";
+        case MetricTimer::FightBatch: return "fight_batch";
+        case MetricTimer::FrameWrite: return "frame_write";
+        case MetricTimer::PageIn: return "page_in";
+        case MetricTimer::PageOut: return "page_out";
+        default: return "unknown";
+    }
+}
+
+size_t LatencyHistogram::bucket_of(std::uint64_t ns) {
+    if (ns < 16)
+        return static_cast<size_t>(ns);
+    unsigned e = static_cast<unsigned>(std::bit_width(ns)) - 1; // 4..63
+    size_t sub = static_cast<size_t>(ns >> (e - 3)) & 7;
+    return 16 + (e - 4) * 8 + sub;
+}
+
+std::uint64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < 16)
+        return bucket;
+    unsigned e = static_cast<unsigned>((bucket - 16) / 8) + 4;
+    std::uint64_t sub = (bucket - 16) % 8;
+    std::uint64_t lower = (8 + sub) << (e - 3);
+    return lower + ((std::uint64_t(1) << (e - 3)) - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t ns) {
+    buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t seen = max_ns.load(std::memory_order_relaxed);
+    while (ns > seen && !max_ns.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto &b : buckets)
+        b.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum_ns.store(0, std::memory_order_relaxed);
+    max_ns.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const {
+    std::uint64_t n = count();
+    if (n == 0)
+        return 0;
+    auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(n)));
+    rank = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(bucket_upper(i), max());
+    }
+    return max();
+}
+
+void Metrics::reset() {
+    for (auto &c : counters)
+        c.store(0, std::memory_order_relaxed);
+    for (auto &t : timers)
+        t.reset();
+}
+
+void Metrics::export_json(std::ostream &os) const {
+    os << "{\n  \"counters\": {";
+    for (size_t c = 0; c < counters.size(); ++c) {
+        os << (c ? ",\n" : "\n") << "    \"" << metric_name(static_cast<MetricCounter>(c)) << "\": "
+           << counters[c].load(std::memory_order_relaxed);
+    }
+    os << "\n  },\n  \"timers\": {";
+    for (size_t t = 0; t < timers.size(); ++t) {
+        const auto &h = timers[t];
+        os << (t ? ",\n" : "\n") << "    \"" << metric_name(static_cast<MetricTimer>(t)) << "\": {"
+           << "\"count\": " << h.count() << ", \"sum_ns\": " << h.sum()
+           << ", \"p50_ns\": " << h.percentile(0.5) << ", \"p99_ns\": " << h.percentile(0.99)
+           << ", \"max_ns\": " << h.max() << "}";
+    }
+    os << "\n  }\n}\n";
+}
+
+void Metrics::export_prometheus(std::ostream &os) const {
+    for (size_t c = 0; c < counters.size(); ++c) {
+        const char *name = metric_name(static_cast<MetricCounter>(c));
+        os << "# TYPE lab7_" << name << "_total counter\n"
+           << "lab7_" << name << "_total " << counters[c].load(std::memory_order_relaxed) << '\n';
+    }
+    os << "# TYPE lab7_phase_latency_seconds summary\n";
+    for (size_t t = 0; t < timers.size(); ++t) {
+        const auto &h = timers[t];
+        const char *name = metric_name(static_cast<MetricTimer>(t));
+        for (double q : {0.5, 0.99}) {
+            os << "lab7_phase_latency_seconds{phase=\"" << name << "\",quantile=\"" << q << "\"} "
+               << static_cast<double>(h.percentile(q)) * 1e-9 << '\n';
+        }
+        os << "lab7_phase_latency_seconds_sum{phase=\"" << name << "\"} " << static_cast<double>(h.sum()) * 1e-9 << '\n'
+           << "lab7_phase_latency_seconds_count{phase=\"" << name << "\"} " << h.count() << '\n';
+    }
+}
+
+Metrics &metrics() {
+    static Metrics *instance = new Metrics; // живёт до конца процесса: фоновые потоки пишут до выхода
+    return *instance;
+}
@@ -0,0 +1,45 @@
+#include "../include/name_table.h"
+#include <bit>
+
+unsigned NameTable::block_of(std::uint32_t id, size_t &offset) {
+    std::uint64_t n = std::uint64_t(id) + (1u << FIRST_BITS);
+    unsigned block = static_cast<unsigned>(std::bit_width(n)) - FIRST_BITS - 1;
+    offset = static_cast<size_t>(n - (std::uint64_t(1) << (block + FIRST_BITS)));
+    return block;
+}
+
+const std::string &NameTable::slot(std::uint32_t id) const {
+    size_t offset;
+    unsigned block = block_of(id, offset);
+    return blocks[block][offset];
+}
+
+void NameTable::push(std::string_view name) {
+    size_t id = count.load(std::memory_order_relaxed);
+    size_t offset;
+    unsigned block = block_of(static_cast<std::uint32_t>(id), offset);
+    if (!blocks[block])
+        blocks[block] = std::make_unique<std::string[]>(size_t(1) << (block + FIRST_BITS));
+    std::string &stored = blocks[block][offset];
+    stored.assign(name);
+    index.try_emplace(stored, static_cast<std::uint32_t>(id));
+    // Строка видна читателям только после публикации размера
+    count.store(id + 1, std::memory_order_release);
+}
+
+std::uint32_t NameTable::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (auto it = index.find(name); it != index.end())
+        return it->second;
+    std::uint32_t id = static_cast<std::uint32_t>(count.load(std::memory_order_relaxed));
+    push(name);
+    return id;
+}
+
+void NameTable::assign(std::span<const std::string_view> names) {
+    std::lock_guard<std::mutex> lock(mtx);
+    index.clear();
+    count.store(0, std::memory_order_relaxed);
+    for (std::string_view name : names)
+        push(name);
+}
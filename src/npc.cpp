@@ -2,65 +2,93 @@
 #include "../include/knight.h"
 #include "../include/bear.h"
 #include "../include/orc.h"
+#include "../include/world.h"
+#include "../include/npc_registry.h"
 #include <random>
 #include <sstream>
 
-// Списки имен для каждого типа NPC
-namespace Names {
-    const std::vector<std::string> KnightNames = {
-        "Arthur", "Lancelot", "Galahad", "Percival", "Gawain",
-        "Bedivere", "Tristan", "Gareth", "Bors", "Mordred"
-    };
-    
-    const std::vector<std::string> OrcNames = {
-        "Grom", "Mog", "Thrak", "Gul'dan", "Kargath",
-        "Nazgrim", "Garrosh", "Durotan", "Blackhand", "Kilrogg"
-    };
-    
-    const std::vector<std::string> BearNames = {
-        "Baloo", "Winnie", "Yogi", "Smokey", "Paddington",
-        "Fozzie", "Boo-Boo", "Gentle", "Grizzly", "Kodiak"
-    };
+const std::vector<std::string> &name_pool(NpcType type) {
+    return npc_registry().info(type).names;
+}
+
+NameTable &npc_names() {
+    static NameTable *table = [] {
+        auto *names = new NameTable; // живёт до конца процесса
+        for (NpcType type : {KnightType, OrcType, BearType})
+            for (auto &name : name_pool(type))
+                names->intern(name);
+        return names;
+    }();
+    return *table;
 }
 
 // Генератор случайных имен
 std::string generate_random_name(NpcType type) {
     static std::random_device rd;
     static std::mt19937 gen(rd());
-    
-    switch(type) {
-        case KnightType: {
-            std::uniform_int_distribution<> dis(0, Names::KnightNames.size() - 1);
-            return Names::KnightNames[dis(gen)];
-        }
-        case OrcType: {
-            std::uniform_int_distribution<> dis(0, Names::OrcNames.size() - 1);
-            return Names::OrcNames[dis(gen)];
-        }
-        case BearType: {
-            std::uniform_int_distribution<> dis(0, Names::BearNames.size() - 1);
-            return Names::BearNames[dis(gen)];
-        }
-        default:
-            return "Unknown";
+
+    const auto &pool = name_pool(type);
+    std::uniform_int_distribution<size_t> dis(0, pool.size() - 1);
+    return pool[dis(gen)];
+}
+
+namespace {
+    constexpr std::uint64_t ALIVE_BIT = std::uint64_t(1) << 63;
+    constexpr std::uint64_t COORD_MASK = (std::uint64_t(1) << 31) - 1;
+
+    std::uint64_t pack(int x, int y, bool alive) {
+        return (static_cast<std::uint64_t>(x) & COORD_MASK)
+            | ((static_cast<std::uint64_t>(y) & COORD_MASK) << 31)
+            | (alive ? ALIVE_BIT : 0);
+    }
+
+    int unpack_coord(std::uint64_t bits) {
+        // Расширение знака 31-битного числа
+        auto raw = static_cast<std::uint32_t>(bits & COORD_MASK) << 1;
+        return static_cast<std::int32_t>(raw) >> 1;
     }
+
+    int unpack_x(std::uint64_t s) { return unpack_coord(s); }
+    int unpack_y(std::uint64_t s) { return unpack_coord(s >> 31); }
 }
 
 NPC::NPC(NpcType t, int _x, int _y, const std::string& _name) 
-    : type(t), x(_x), y(_y), name(_name.empty() ? generate_random_name(t) : _name) {}
+    : type(t), state(pack(_x, _y, true)),
+      name_id(npc_names().intern(_name.empty() ? generate_random_name(t) : _name)) {}
 
 NPC::NPC(NpcType t, std::istream &is) : type(t) {
+    int x{0}, y{0};
+    std::string name;
     is >> x;
     is >> y;
     std::getline(is >> std::ws, name);
     if (name.empty()) {
         name = generate_random_name(t);
     }
+    name_id = npc_names().intern(name);
+    state.store(pack(x, y, true), std::memory_order_release);
 }
 
-std::string NPC::get_name() const {
-    std::lock_guard<std::mutex> lck(mtx);  // Теперь работает с mutable мьютексом
-    return name;
+NPC::NPC(NpcType t, World &w, EntityId _id) : type(t), world(&w), id(_id) {}
+
+const char *type_name(NpcType type) {
+    return npc_registry().info(type).name.c_str();
+}
+
+int move_distance(NpcType type) {
+    return npc_registry().info(type).move_range;
+}
+
+std::string_view NPC::get_name() const {
+    // Строки таблиц имён не перемещаются, сама строка читается без блокировки.
+    // id имени берётся из мира на каждый вызов (слот мог занять другой NPC),
+    // а столбец name_ids растёт со spawn и может переехать - его читаем
+    // под shared-блокировкой мира
+    if (world) {
+        std::shared_lock lck(world->mutex());
+        return world->name(id);
+    }
+    return npc_names().view(name_id);
 }
 
 bool NPC::visit(std::shared_ptr<Orc> orc) {
@@ -84,7 +112,7 @@ void NPC::fight_notify(const std::shared_ptr<NPC> defender, bool win) {
 
 bool NPC::is_close(const std::shared_ptr<NPC> &other, size_t distance) {
     auto [other_x, other_y] = other->position();
-    std::lock_guard<std::mutex> lck(mtx);
+    auto [x, y] = position();
     
     if ((std::pow(x - other_x, 2) + std::pow(y - other_y, 2)) <= std::pow(distance, 2))
         return true;
@@ -92,60 +120,68 @@ bool NPC::is_close(const std::shared_ptr<NPC> &other, size_t distance) {
         return false;
 }
 
-NpcType NPC::get_type() {
-    std::lock_guard<std::mutex> lck(mtx);
-    return type;
-}
-
 std::pair<int, int> NPC::position() {
-    std::lock_guard<std::mutex> lck(mtx);
-    return {x, y};
+    if (world) {
+        std::shared_lock lck(world->mutex());
+        return world->position(id);
+    }
+    std::uint64_t s = state.load(std::memory_order_acquire);
+    return {unpack_x(s), unpack_y(s)};
 }
 
 void NPC::save(std::ostream &os) {
-    std::lock_guard<std::mutex> lck(mtx);
+    auto [x, y] = position();
     os << x << std::endl;
     os << y << std::endl;
-    os << name << std::endl;
+    os << get_name() << std::endl;
 }
 
 std::ostream &operator<<(std::ostream &os, NPC &npc) {
-    std::lock_guard<std::mutex> lck(npc.mtx);
-    os << "{ x:" << npc.x << ", y:" << npc.y << ", name:\"" << npc.name << "\"} ";
+    auto [x, y] = npc.position();
+    os << "{ x:" << x << ", y:" << y << ", name:\"" << npc.get_name() << "\"} ";
     return os;
 }
 
 void NPC::move(int shift_x, int shift_y, int max_x, int max_y) {
-    if (!alive) return; // Мертвые не двигаются
-    
-    std::lock_guard<std::mutex> lck(mtx);
-    int move_distance = 0;
-
-    if (this->type == OrcType) {
-        move_distance = 20;
+    if (world) {
+        // Границы карты задаёт сам мир
+        std::unique_lock lck(world->mutex());
+        world->move(id, shift_x, shift_y);
+        return;
     }
-    else if (this->type == BearType) {
-        move_distance = 5;
-    }        
-    else if (this->type == KnightType) {
-        move_distance = 30;
+    int distance = move_distance(type);
+    shift_x = (shift_x >= 0) ? distance : -distance;
+    shift_y = (shift_y >= 0) ? distance : -distance;
+
+    // CAS, чтобы одновременный must_die не потерялся
+    std::uint64_t s = state.load(std::memory_order_acquire);
+    for (;;) {
+        if (!(s & ALIVE_BIT)) return; // Мертвые не двигаются
+
+        int x = unpack_x(s), y = unpack_y(s);
+        if ((x + shift_x >= 0) && (x + shift_x <= max_x))
+            x += shift_x;
+        if ((y + shift_y >= 0) && (y + shift_y <= max_y))
+            y += shift_y;
+
+        if (state.compare_exchange_weak(s, pack(x, y, true), std::memory_order_acq_rel))
+            return;
     }
-
-    shift_x = (shift_x >= 0) ? move_distance : -move_distance;
-    shift_y = (shift_y >= 0) ? move_distance : -move_distance;
-
-    if ((x + shift_x >= 0) && (x + shift_x <= max_x))
-        x += shift_x;
-    if ((y + shift_y >= 0) && (y + shift_y <= max_y))
-        y += shift_y;
 }
 
 bool NPC::is_alive() {
-    std::lock_guard<std::mutex> lck(mtx);
-    return alive;
+    if (world) {
+        std::shared_lock lck(world->mutex());
+        return world->is_alive(id);
+    }
+    return (state.load(std::memory_order_acquire) & ALIVE_BIT) != 0;
 }
 
 void NPC::must_die() {
-    std::lock_guard<std::mutex> lck(mtx);
-    alive = false;
+    if (world) {
+        std::unique_lock lck(world->mutex());
+        world->kill(id);
+        return;
+    }
+    state.fetch_and(~ALIVE_BIT, std::memory_order_acq_rel);
 }
\ No newline at end of file
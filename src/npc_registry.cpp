@@ -0,0 +1,107 @@
+#include "../include/npc_registry.h"
+#include "../include/fight_table.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+// Списки имен для каждого типа NPC
+namespace Names {
+    const std::vector<std::string> KnightNames = {
+        "Arthur", "Lancelot", "Galahad", "Percival", "Gawain",
+        "Bedivere", "Tristan", "Gareth", "Bors", "Mordred"
+    };
+    
+    const std::vector<std::string> OrcNames = {
+        "Grom", "Mog", "Thrak", "Gul'dan", "Kargath",
+        "Nazgrim", "Garrosh", "Durotan", "Blackhand", "Kilrogg"
+    };
+    
+    const std::vector<std::string> BearNames = {
+        "Baloo", "Winnie", "Yogi", "Smokey", "Paddington",
+        "Fozzie", "Boo-Boo", "Gentle", "Grizzly", "Kodiak"
+    };
+}
+
+namespace {
+    bool same_name(std::string_view a, std::string_view b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+}
+
+NpcRegistry::NpcRegistry() {
+    // Ссылки из info() не должны смещаться при add()
+    types.reserve(MAX_NPC_TYPES);
+    types.push_back({"Unknown", 0, DEFAULT_MOVE_RANGES[Unknown], {"Unknown"}});
+    types.push_back({"Orc", 'O', DEFAULT_MOVE_RANGES[OrcType], Names::OrcNames});
+    types.push_back({"Knight", 'K', DEFAULT_MOVE_RANGES[KnightType], Names::KnightNames});
+    types.push_back({"Bear", 'B', DEFAULT_MOVE_RANGES[BearType], Names::BearNames});
+    for (size_t t = 0; t < types.size(); ++t)
+        glyphs[t] = types[t].glyph;
+
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a)
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d)
+            matrix[a * MAX_NPC_TYPES + d] = fight_table[a][d];
+}
+
+NpcType NpcRegistry::add(NpcTypeInfo info) {
+    if (types.size() >= MAX_NPC_TYPES) {
+        std::cerr << "too many NPC types, cannot add " << info.name << std::endl;
+        return Unknown;
+    }
+    if (info.name.empty() || find(info.name) != Unknown || same_name(info.name, "Unknown")) {
+        std::cerr << "NPC type name is empty or taken: " << info.name << std::endl;
+        return Unknown;
+    }
+    if (info.names.empty())
+        info.names.push_back(info.name);
+    auto type = static_cast<NpcType>(types.size());
+    glyphs[type] = info.glyph;
+    types.push_back(std::move(info));
+    return type;
+}
+
+void NpcRegistry::set_wins(NpcType attacker, NpcType defender, bool win) {
+    if (static_cast<size_t>(attacker) < MAX_NPC_TYPES && static_cast<size_t>(defender) < MAX_NPC_TYPES)
+        matrix[attacker * MAX_NPC_TYPES + defender] = win;
+}
+
+void NpcRegistry::truncate(size_t count) {
+    count = std::max<size_t>(count, NPC_TYPE_COUNT);
+    for (size_t t = count; t < types.size(); ++t) {
+        glyphs[t] = 0;
+        for (size_t other = 0; other < MAX_NPC_TYPES; ++other) {
+            matrix[t * MAX_NPC_TYPES + other] = 0;
+            matrix[other * MAX_NPC_TYPES + t] = 0;
+        }
+    }
+    if (count < types.size())
+        types.resize(count);
+}
+
+const NpcTypeInfo &NpcRegistry::info(NpcType type) const {
+    auto index = static_cast<size_t>(type);
+    return index < types.size() ? types[index] : types[Unknown];
+}
+
+NpcType NpcRegistry::find(std::string_view name) const {
+    for (size_t t = 1; t < types.size(); ++t) {
+        if (same_name(types[t].name, name))
+            return static_cast<NpcType>(t);
+    }
+    return Unknown;
+}
+
+MoveRanges NpcRegistry::move_ranges() const {
+    MoveRanges ranges;
+    ranges.reserve(types.size());
+    for (const auto &t : types)
+        ranges.push_back(t.move_range);
+    return ranges;
+}
+
+NpcRegistry &npc_registry() {
+    static NpcRegistry *registry = new NpcRegistry; // живёт до конца процесса
+    return *registry;
+}
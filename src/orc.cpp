@@ -4,6 +4,7 @@
 
 Orc::Orc(int x, int y, const std::string& name) : NPC(OrcType, x, y, name) {}
 Orc::Orc(std::istream &is) : NPC(OrcType, is) {}
+Orc::Orc(World &world, EntityId id) : NPC(OrcType, world, id) {}
 
 void Orc::print() {
     std::cout << *this;
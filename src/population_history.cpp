@@ -0,0 +1,30 @@
+#include "../include/population_history.h"
+#include <algorithm>
+#include <ostream>
+
+PopulationHistory::PopulationHistory(size_t capacity) : buffer(std::max<size_t>(capacity, 1)) {}
+
+void PopulationHistory::record(size_t tick, const PopulationCounts &counts) {
+    PopulationSample &sample = buffer[head];
+    sample.tick = static_cast<std::uint32_t>(tick);
+    sample.dead = static_cast<std::uint32_t>(counts.dead);
+    for (size_t t = 0; t < NPC_TYPE_COUNT; ++t)
+        sample.alive[t] = static_cast<std::uint32_t>(counts.alive[t]);
+
+    head = (head + 1) % buffer.size();
+    count = std::min(count + 1, buffer.size());
+}
+
+const PopulationSample &PopulationHistory::operator[](size_t i) const {
+    size_t oldest = (head + buffer.size() - count) % buffer.size();
+    return buffer[(oldest + i) % buffer.size()];
+}
+
+void PopulationHistory::export_csv(std::ostream &os) const {
+    os << "tick,orcs,knights,bears,dead\n";
+    for (size_t i = 0; i < count; ++i) {
+        const PopulationSample &s = (*this)[i];
+        os << s.tick << ',' << s.alive[OrcType] << ',' << s.alive[KnightType] << ','
+           << s.alive[BearType] << ',' << s.dead << '\n';
+    }
+}
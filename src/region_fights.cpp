@@ -0,0 +1,100 @@
+#include "../include/region_fights.h"
+#include "../include/npc_registry.h"
+#include "../include/metrics.h"
+#include <algorithm>
+
+RegionFightResolver::RegionFightResolver(World &w, size_t workers)
+    : world(w), regions(std::max<size_t>(workers, 1)) {
+    // Регион 0 разбирает вызывающий поток, остальные - свои потоки
+    for (size_t i = 1; i < regions.size(); ++i)
+        threads.emplace_back(&RegionFightResolver::worker_loop, this, i);
+}
+
+RegionFightResolver::~RegionFightResolver() {
+    running = false;
+    generation.fetch_add(1);
+    generation.notify_all();
+    for (auto &t : threads)
+        t.join();
+}
+
+size_t RegionFightResolver::region_of(int x) const {
+    long long width = static_cast<long long>(world.max_x()) + 1;
+    long long clamped = std::clamp<long long>(x, 0, width - 1);
+    return static_cast<size_t>(clamped * static_cast<long long>(regions.size()) / width);
+}
+
+bool RegionFightResolver::resolve_one(size_t event, std::vector<FightOutcome> &outcomes) {
+    auto [attacker, defender] = batch[event];
+    if (!world.is_alive(attacker) || !world.is_alive(defender))
+        return false;
+
+    bool win = npc_registry().wins(world.type(attacker), world.type(defender));
+    if (win)
+        world.kill(defender);
+    outcomes.push_back({event, win});
+    return win;
+}
+
+void RegionFightResolver::resolve_region(Region &region) {
+    for (size_t event : region.events)
+        resolve_one(event, region.outcomes);
+}
+
+void RegionFightResolver::worker_loop(size_t index) {
+    std::uint32_t seen = 0;
+    for (;;) {
+        generation.wait(seen);
+        seen = generation.load();
+        if (!running)
+            return;
+        resolve_region(regions[index]);
+        if (pending.fetch_sub(1) == 1)
+            pending.notify_one();
+    }
+}
+
+std::vector<FightOutcome> RegionFightResolver::resolve(std::span<const FightPair> fights) {
+    batch = fights;
+    for (auto &region : regions) {
+        region.events.clear();
+        region.outcomes.clear();
+    }
+    border.clear();
+
+    for (size_t i = 0; i < fights.size(); ++i) {
+        size_t a = region_of(world.x(fights[i].attacker));
+        size_t d = region_of(world.x(fights[i].defender));
+        if (a == d)
+            regions[a].events.push_back(i);
+        else
+            border.push_back(i);
+    }
+
+    if (!threads.empty()) {
+        pending = static_cast<std::uint32_t>(threads.size());
+        generation.fetch_add(1);
+        generation.notify_all();
+    }
+    resolve_region(regions[0]);
+    for (std::uint32_t left = pending.load(); left != 0; left = pending.load())
+        pending.wait(left);
+
+    // Согласование границы: один поток, порядок не зависит от числа потоков
+    std::sort(border.begin(), border.end(), [&fights](size_t l, size_t r) {
+        if (fights[l].attacker != fights[r].attacker)
+            return fights[l].attacker < fights[r].attacker;
+        if (fights[l].defender != fights[r].defender)
+            return fights[l].defender < fights[r].defender;
+        return l < r;
+    });
+
+    std::vector<FightOutcome> outcomes;
+    for (auto &region : regions)
+        outcomes.insert(outcomes.end(), region.outcomes.begin(), region.outcomes.end());
+    for (size_t event : border)
+        resolve_one(event, outcomes);
+    LAB7_COUNT(FightsResolved, outcomes.size());
+    LAB7_COUNT(FightsSkippedDead, fights.size() - outcomes.size());
+    return outcomes;
+}
@@ -0,0 +1,296 @@
+#include "../include/simd_kernels.h"
+#include "../include/npc.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LAB7_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Шаги по умолчанию известны при компиляции и сворачиваются в константы
+struct DefaultSteps {
+    int operator()(std::uint8_t type) const { return type < NPC_TYPE_COUNT ? DEFAULT_MOVE_RANGES[type] : 0; }
+};
+
+struct RuntimeSteps {
+    std::span<const int> steps;
+    int operator()(std::uint8_t type) const { return type < steps.size() ? steps[type] : 0; }
+};
+
+template <int Distance>
+struct FixedLimit {
+    std::uint64_t operator()() const { return std::uint64_t(std::int64_t(Distance) * Distance); }
+};
+
+struct RuntimeLimit {
+    std::uint64_t value;
+    std::uint64_t operator()() const { return value; }
+};
+
+template <typename Steps>
+void move_scalar(const MoveBatch &b, size_t from, int max_x, int max_y, Steps step_of) {
+    for (size_t i = from; i < b.count; ++i) {
+        if (!b.alive[i])
+            continue;
+        int distance = step_of(b.types[i]);
+        int shift_x = (b.dirs[i] & 1) ? distance : -distance;
+        int shift_y = (b.dirs[i] & 2) ? distance : -distance;
+        if ((b.xs[i] + shift_x >= 0) && (b.xs[i] + shift_x <= max_x))
+            b.xs[i] += shift_x;
+        if ((b.ys[i] + shift_y >= 0) && (b.ys[i] + shift_y <= max_y))
+            b.ys[i] += shift_y;
+    }
+}
+
+void move_scalar(const MoveBatch &b, size_t from, int max_x, int max_y) {
+    if (std::equal(b.steps.begin(), b.steps.end(), DEFAULT_MOVE_RANGES.begin(), DEFAULT_MOVE_RANGES.end()))
+        move_scalar(b, from, max_x, max_y, DefaultSteps{});
+    else
+        move_scalar(b, from, max_x, max_y, RuntimeSteps{b.steps});
+}
+
+void distances_scalar(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                      size_t from, size_t count, std::uint64_t *out) {
+    for (size_t i = from; i < count; ++i) {
+        // Разность с переполнением по модулю 2^32, как вычитание int в векторе
+        auto dx = static_cast<std::int32_t>(static_cast<std::uint32_t>(xs[a[i]]) - static_cast<std::uint32_t>(xs[b[i]]));
+        auto dy = static_cast<std::int32_t>(static_cast<std::uint32_t>(ys[a[i]]) - static_cast<std::uint32_t>(ys[b[i]]));
+        out[i] = static_cast<std::uint64_t>(std::int64_t(dx) * dx) + static_cast<std::uint64_t>(std::int64_t(dy) * dy);
+    }
+}
+
+#ifdef LAB7_X86_SIMD
+
+inline int load4(const std::uint8_t *bytes) {
+    int v;
+    std::memcpy(&v, bytes, sizeof(v));
+    return v;
+}
+
+// Сдвиги для 4 сущностей: шаг типа со знаком по биту направления.
+// Сборки в SSE нет, шаги выбираются из таблицы скалярно
+__attribute__((target("sse4.1")))
+inline void shifts_sse(const MoveBatch &b, size_t i, __m128i &sx, __m128i &sy, __m128i &live) {
+    RuntimeSteps step_of{b.steps};
+    __m128i step = _mm_setr_epi32(step_of(b.types[i]), step_of(b.types[i + 1]),
+                                  step_of(b.types[i + 2]), step_of(b.types[i + 3]));
+    __m128i neg = _mm_sub_epi32(_mm_setzero_si128(), step);
+
+    __m128i dir = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(load4(b.dirs + i)));
+    __m128i right = _mm_cmpeq_epi32(_mm_and_si128(dir, _mm_set1_epi32(1)), _mm_set1_epi32(1));
+    __m128i down = _mm_cmpeq_epi32(_mm_and_si128(dir, _mm_set1_epi32(2)), _mm_set1_epi32(2));
+    sx = _mm_blendv_epi8(neg, step, right);
+    sy = _mm_blendv_epi8(neg, step, down);
+
+    __m128i alive = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(load4(b.alive + i)));
+    live = _mm_xor_si128(_mm_cmpeq_epi32(alive, _mm_setzero_si128()), _mm_set1_epi32(-1));
+}
+
+__attribute__((target("sse4.1")))
+inline __m128i step_axis_sse(__m128i pos, __m128i shift, __m128i live, __m128i max) {
+    __m128i moved = _mm_add_epi32(pos, shift);
+    __m128i ok = _mm_and_si128(live, _mm_cmpgt_epi32(moved, _mm_set1_epi32(-1)));
+    ok = _mm_andnot_si128(_mm_cmpgt_epi32(moved, max), ok);
+    return _mm_blendv_epi8(pos, moved, ok);
+}
+
+__attribute__((target("sse4.1")))
+void move_sse41(const MoveBatch &b, int max_x, int max_y) {
+    const __m128i mx = _mm_set1_epi32(max_x);
+    const __m128i my = _mm_set1_epi32(max_y);
+    size_t i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        __m128i sx, sy, live;
+        shifts_sse(b, i, sx, sy, live);
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.xs + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.ys + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(b.xs + i), step_axis_sse(x, sx, live, mx));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(b.ys + i), step_axis_sse(y, sy, live, my));
+    }
+    move_scalar(b, i, max_x, max_y);
+}
+
+__attribute__((target("avx2")))
+inline __m256i step_axis_avx2(__m256i pos, __m256i shift, __m256i live, __m256i max) {
+    __m256i moved = _mm256_add_epi32(pos, shift);
+    __m256i ok = _mm256_and_si256(live, _mm256_cmpgt_epi32(moved, _mm256_set1_epi32(-1)));
+    ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(moved, max), ok);
+    return _mm256_blendv_epi8(pos, moved, ok);
+}
+
+__attribute__((target("avx2")))
+void move_avx2(const MoveBatch &b, int max_x, int max_y) {
+    if (b.steps.empty()) {
+        move_scalar(b, 0, max_x, max_y);
+        return;
+    }
+    // Тип за концом таблицы читает последний шаг, затем обнуляется маской
+    const __m256i last = _mm256_set1_epi32(static_cast<int>(b.steps.size() - 1));
+    const __m256i known = _mm256_set1_epi32(static_cast<int>(b.steps.size()));
+    const __m256i mx = _mm256_set1_epi32(max_x);
+    const __m256i my = _mm256_set1_epi32(max_y);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    size_t i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        __m256i t = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(b.types + i)));
+        __m256i step = _mm256_i32gather_epi32(b.steps.data(), _mm256_min_epu32(t, last), 4);
+        step = _mm256_and_si256(step, _mm256_cmpgt_epi32(known, t));
+        __m256i neg = _mm256_sub_epi32(_mm256_setzero_si256(), step);
+
+        __m256i dir = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(b.dirs + i)));
+        __m256i sx = _mm256_blendv_epi8(neg, step, _mm256_cmpeq_epi32(_mm256_and_si256(dir, one), one));
+        __m256i sy = _mm256_blendv_epi8(neg, step, _mm256_cmpeq_epi32(_mm256_and_si256(dir, two), two));
+
+        __m256i alive = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(b.alive + i)));
+        __m256i live = _mm256_xor_si256(_mm256_cmpeq_epi32(alive, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b.xs + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b.ys + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(b.xs + i), step_axis_avx2(x, sx, live, mx));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(b.ys + i), step_axis_avx2(y, sy, live, my));
+    }
+    move_scalar(b, i, max_x, max_y);
+}
+
+// dx^2 + dy^2 для четырёх пар по 64 бита: чётные и нечётные дорожки отдельно
+__attribute__((target("sse4.1")))
+inline void square_sum_sse(__m128i dx, __m128i dy, std::uint64_t *out) {
+    __m128i even = _mm_add_epi64(_mm_mul_epi32(dx, dx), _mm_mul_epi32(dy, dy));
+    __m128i dx_odd = _mm_srli_epi64(dx, 32), dy_odd = _mm_srli_epi64(dy, 32);
+    __m128i odd = _mm_add_epi64(_mm_mul_epi32(dx_odd, dx_odd), _mm_mul_epi32(dy_odd, dy_odd));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi64(even, odd));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2), _mm_unpackhi_epi64(even, odd));
+}
+
+__attribute__((target("sse4.1")))
+void distances_sse41(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                     size_t count, std::uint64_t *out) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Сборки нет, координаты собираются скалярно
+        __m128i xa = _mm_setr_epi32(xs[a[i]], xs[a[i + 1]], xs[a[i + 2]], xs[a[i + 3]]);
+        __m128i xb = _mm_setr_epi32(xs[b[i]], xs[b[i + 1]], xs[b[i + 2]], xs[b[i + 3]]);
+        __m128i ya = _mm_setr_epi32(ys[a[i]], ys[a[i + 1]], ys[a[i + 2]], ys[a[i + 3]]);
+        __m128i yb = _mm_setr_epi32(ys[b[i]], ys[b[i + 1]], ys[b[i + 2]], ys[b[i + 3]]);
+        square_sum_sse(_mm_sub_epi32(xa, xb), _mm_sub_epi32(ya, yb), out + i);
+    }
+    distances_scalar(xs, ys, a, b, i, count, out);
+}
+
+__attribute__((target("avx2")))
+void distances_avx2(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                    size_t count, std::uint64_t *out) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i ia = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i ib = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i dx = _mm256_sub_epi32(_mm256_i32gather_epi32(xs, ia, 4), _mm256_i32gather_epi32(xs, ib, 4));
+        __m256i dy = _mm256_sub_epi32(_mm256_i32gather_epi32(ys, ia, 4), _mm256_i32gather_epi32(ys, ib, 4));
+
+        __m256i even = _mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy));
+        __m256i dx_odd = _mm256_srli_epi64(dx, 32), dy_odd = _mm256_srli_epi64(dy, 32);
+        __m256i odd = _mm256_add_epi64(_mm256_mul_epi32(dx_odd, dx_odd), _mm256_mul_epi32(dy_odd, dy_odd));
+        // [e0 o1 | e4 o5] и [e2 o3 | e6 o7] -> по порядку пар
+        __m256i lo = _mm256_unpacklo_epi64(even, odd);
+        __m256i hi = _mm256_unpackhi_epi64(even, odd);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    distances_scalar(xs, ys, a, b, i, count, out);
+}
+
+#endif
+
+SimdLevel usable(SimdLevel level) {
+    return std::min(level, detected_simd_level());
+}
+
+// Расстояния считаются блоками на стеке, номера близких пар пишутся без ветвлений
+template <typename Limit>
+size_t collect_close(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                   size_t count, Limit limit, std::uint32_t *out, SimdLevel level) {
+    constexpr size_t BLOCK = 256;
+    std::uint64_t d[BLOCK];
+    size_t found = 0;
+    for (size_t from = 0; from < count; from += BLOCK) {
+        size_t len = std::min(BLOCK, count - from);
+        squared_distances(xs, ys, a + from, b + from, len, d, level);
+        for (size_t j = 0; j < len; ++j) {
+            out[found] = static_cast<std::uint32_t>(from + j);
+            found += d[j] <= limit();
+        }
+    }
+    return found;
+}
+
+}
+
+SimdLevel detected_simd_level() {
+    static const SimdLevel level = [] {
+#ifdef LAB7_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::Avx2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return SimdLevel::Sse41;
+#endif
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+const char *simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+void move_batch(const MoveBatch &batch, int max_x, int max_y) {
+    move_batch(batch, max_x, max_y, detected_simd_level());
+}
+
+void move_batch(const MoveBatch &batch, int max_x, int max_y, SimdLevel level) {
+    switch (usable(level)) {
+#ifdef LAB7_X86_SIMD
+        case SimdLevel::Avx2: move_avx2(batch, max_x, max_y); return;
+        case SimdLevel::Sse41: move_sse41(batch, max_x, max_y); return;
+#endif
+        default: move_scalar(batch, 0, max_x, max_y); return;
+    }
+}
+
+void squared_distances(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                       size_t count, std::uint64_t *out) {
+    squared_distances(xs, ys, a, b, count, out, detected_simd_level());
+}
+
+void squared_distances(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                       size_t count, std::uint64_t *out, SimdLevel level) {
+    switch (usable(level)) {
+#ifdef LAB7_X86_SIMD
+        case SimdLevel::Avx2: distances_avx2(xs, ys, a, b, count, out); return;
+        case SimdLevel::Sse41: distances_sse41(xs, ys, a, b, count, out); return;
+#endif
+        default: distances_scalar(xs, ys, a, b, 0, count, out); return;
+    }
+}
+
+size_t close_pairs(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                   size_t count, int distance, std::uint32_t *out) {
+    return close_pairs(xs, ys, a, b, count, distance, out, detected_simd_level());
+}
+
+size_t close_pairs(const int *xs, const int *ys, const std::uint32_t *a, const std::uint32_t *b,
+                   size_t count, int distance, std::uint32_t *out, SimdLevel level) {
+    level = usable(level);
+    if (distance == DEFAULT_KILL_DISTANCE)
+        return collect_close(xs, ys, a, b, count, FixedLimit<DEFAULT_KILL_DISTANCE>{}, out, level);
+    auto limit = static_cast<std::uint64_t>(std::int64_t(distance) * distance);
+    return collect_close(xs, ys, a, b, count, RuntimeLimit{limit}, out, level);
+}
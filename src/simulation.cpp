@@ -0,0 +1,271 @@
+#include "../include/simulation.h"
+#include "../include/rng.h"
+#include "../include/simd_kernels.h"
+#include "../include/metrics.h"
+#include "../include/fight_candidates.h"
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+
+namespace {
+    // id сущностей 32-битные, поэтому стрим расселения с ними не пересекается
+    constexpr std::uint64_t SPAWN_STREAM = ~std::uint64_t(0);
+
+    void hash_bytes(std::uint64_t &h, const void *data, size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+}
+
+void PopulationSpec::set(NpcType type, size_t count) {
+    switch (type) {
+        case OrcType: orcs = count; return;
+        case KnightType: knights = count; return;
+        case BearType: bears = count; return;
+        default: break;
+    }
+    for (auto &[other, n] : others) {
+        if (other == type) {
+            n = count;
+            return;
+        }
+    }
+    others.emplace_back(type, count);
+}
+
+void place_population(const SimulationConfig &config,
+                      const std::function<void(NpcType, int, int, const std::string &)> &place) {
+    const auto &pop = config.population;
+    CounterRng rng(config.seed, SPAWN_STREAM);
+    auto spawn = [&](NpcType type, size_t count) {
+        const auto &pool = name_pool(type);
+        for (size_t i = 0; i < count; ++i) {
+            int x = static_cast<int>(rng.uniform(static_cast<std::uint32_t>(config.max_x)));
+            int y = static_cast<int>(rng.uniform(static_cast<std::uint32_t>(config.max_y)));
+            place(type, x, y, pool[rng.uniform(static_cast<std::uint32_t>(pool.size()))]);
+        }
+    };
+    spawn(OrcType, pop.orcs);
+    spawn(KnightType, pop.knights);
+    spawn(BearType, pop.bears);
+    for (auto [type, count] : pop.others)
+        spawn(type, count);
+}
+
+Simulation::Simulation(const SimulationConfig &config)
+    : Simulation(config, std::make_unique<World>(config.max_x, config.max_y)) {
+    populate();
+}
+
+Simulation::Simulation(const SimulationConfig &config, std::unique_ptr<World> w)
+    : Simulation(config, std::move(w), MapArea{}) {}
+
+Simulation::Simulation(const SimulationConfig &config, std::unique_ptr<World> w, const MapArea &area)
+    : cfg(config),
+      world(std::move(w)),
+      grid(area.empty() ? MapArea{0, 0, world->max_x(), world->max_y()} : area, cfg.distance),
+      resolver(*world, cfg.fight_workers),
+      population(cfg.history_ticks),
+      spawner(cfg.seed, cfg.spawn_rates, cfg.population_cap) {
+    if (!cfg.move_ranges.empty())
+        world->set_move_ranges(cfg.move_ranges);
+    cfg.max_x = world->max_x();
+    cfg.max_y = world->max_y();
+    for (EntityId id : world->live_ids())
+        grid.insert(id, world->x(id), world->y(id));
+    if (cfg.fight_thread) {
+        fight_queue = std::make_unique<FightManager>(*world);
+        fight_queue->set_parallel(cfg.fight_workers);
+        fight_queue->set_event_bus(&bus);
+        fight_worker = std::thread(std::ref(*fight_queue));
+    }
+}
+
+Simulation::~Simulation() {
+    finish();
+}
+
+void Simulation::finish() {
+    if (!fight_worker.joinable())
+        return;
+    fight_queue->stop();
+    fight_worker.join();
+    // Потребитель остановлен, остаток разбирает этот поток
+    fight_queue->drain();
+    std::shared_lock lock(world->mutex());
+    bus.dispatch(*world);
+}
+
+void Simulation::populate() {
+    const auto &pop = cfg.population;
+    size_t total = pop.orcs + pop.knights + pop.bears;
+    for (auto [type, count] : pop.others)
+        total += count;
+    world->reserve(world->size() + total);
+    place_population(cfg, [this](NpcType type, int x, int y, const std::string &name) {
+        EntityId id = world->spawn(type, x, y, name);
+        grid.insert(id, x, y);
+    });
+}
+
+void Simulation::move_phase(size_t tick) {
+    std::unique_lock lock(world->mutex());
+    const size_t n = world->size();
+    auto alive = world->alive_data();
+    auto live = world->live_ids();
+    dirs.assign(n, 0);
+    for (EntityId id : live) {
+        // Стрим сущности, счётчик - номер такта: от порядка обхода не зависит
+        if (alive[id])
+            dirs[id] = static_cast<std::uint8_t>(CounterRng(cfg.seed, id).at(tick) & 3);
+    }
+    auto xs = world->x_data();
+    auto ys = world->y_data();
+    old_xs.assign(xs.begin(), xs.end());
+    old_ys.assign(ys.begin(), ys.end());
+
+    world->move_all(dirs);
+
+    for (EntityId id : live) {
+        if (alive[id])
+            grid.update(id, old_xs[id], old_ys[id], xs[id], ys[id]);
+    }
+}
+
+void Simulation::detect_phase(size_t) {
+    std::shared_lock lock(world->mutex());
+    fights.clear();
+    pair_a.clear();
+    pair_b.clear();
+    grid.for_each_candidate_pair([this](EntityId a, EntityId b) {
+        if (world->is_alive(a) && world->is_alive(b)) {
+            pair_a.push_back(a);
+            pair_b.push_back(b);
+        }
+    });
+    pair_close.resize(pair_a.size());
+    size_t found = close_pairs(world->x_data().data(), world->y_data().data(),
+                               pair_a.data(), pair_b.data(), pair_a.size(), cfg.distance, pair_close.data());
+    // Сетка выдаёт каждую неупорядоченную пару один раз за такт,
+    // поэтому на пару приходится одно событие
+    if (fight_queue) {
+        // Пара, ещё не разобранная с прошлых тактов, второй раз не встанет
+        for (size_t k = 0; k < found; ++k) {
+            std::uint32_t i = pair_close[k];
+            fight_queue->add_candidate(pair_a[i], pair_b[i]);
+        }
+        return;
+    }
+    for (size_t k = 0; k < found; ++k) {
+        std::uint32_t i = pair_close[k];
+        fights.push_back(canonical_fight(*world, pair_a[i], pair_b[i]));
+    }
+    LAB7_COUNT(FightsEnqueued, fights.size());
+}
+
+void Simulation::fight_phase(size_t) {
+    if (fight_queue)
+        return; // разбирает поток боёв
+    std::unique_lock lock(world->mutex());
+    auto outcomes = resolver.resolve(fights);
+    for (auto &outcome : outcomes) {
+        auto [attacker, defender] = fights[outcome.event];
+        bus.publish({attacker, defender,
+                     static_cast<std::uint8_t>(world->type(attacker)),
+                     static_cast<std::uint8_t>(world->type(defender)),
+                     outcome.win});
+    }
+}
+
+void Simulation::compact_phase(size_t tick) {
+    std::unique_lock lock(world->mutex());
+    // Поток боёв мог опубликовать исходы после Observe; их id должны
+    // дойти до наблюдателей раньше, чем слоты освободятся
+    if (fight_queue)
+        bus.dispatch(*world);
+    size_t buried = world->compact(static_cast<std::uint32_t>(tick));
+    grid.remove_sorted(world->buried(), world->x_data(), world->y_data());
+    LAB7_COUNT(NpcsBuried, buried);
+}
+
+void Simulation::spawn_phase(size_t tick) {
+    std::unique_lock lock(world->mutex());
+    size_t born = spawner.run(*world, grid, tick);
+    LAB7_COUNT(NpcsSpawned, born);
+}
+
+void Simulation::end_tick(size_t tick) {
+    population.record(tick, world->population());
+    ++ticks_done;
+    {
+        std::shared_lock lock(world->mutex());
+        bus.dispatch(*world);
+    }
+    compact_phase(tick);
+    if (!spawner.empty())
+        spawn_phase(tick);
+}
+
+EntityId Simulation::spawn(NpcType type, int x, int y, std::string_view name) {
+    std::unique_lock lock(world->mutex());
+    EntityId id = world->spawn(type, x, y, name);
+    grid.insert(id, x, y);
+    return id;
+}
+
+void Simulation::emigrate(EntityId id) {
+    std::unique_lock lock(world->mutex());
+    if (!world->is_alive(id))
+        return;
+    grid.remove(id, world->x(id), world->y(id));
+    world->kill(id);
+    world->release(id); // снимает и запись в мёртвые
+}
+
+void Simulation::attach(TickScheduler &scheduler) {
+    scheduler.on(TickPhase::Move, [this](size_t tick) { move_phase(tick); });
+    scheduler.on(TickPhase::Detect, [this](size_t tick) { detect_phase(tick); });
+    scheduler.on(TickPhase::Fight, [this](size_t tick) {
+        fight_phase(tick);
+        population.record(tick, world->population());
+        ++ticks_done;
+    });
+    scheduler.on(TickPhase::Observe, [this](size_t) {
+        std::shared_lock lock(world->mutex());
+        bus.dispatch(*world);
+    });
+    scheduler.on(TickPhase::Compact, [this](size_t tick) { compact_phase(tick); });
+    if (!spawner.empty())
+        scheduler.on(TickPhase::Spawn, [this](size_t tick) { spawn_phase(tick); });
+}
+
+SimulationResult Simulation::run() {
+    TickScheduler scheduler(0.0);
+    attach(scheduler);
+    scheduler.run(cfg.ticks);
+    finish();
+    return summary();
+}
+
+SimulationResult Simulation::summary() const {
+    SimulationResult result;
+    PopulationCounts counts = world->population();
+    result.ticks = ticks_done;
+    result.knights = counts.of(KnightType);
+    result.orcs = counts.of(OrcType);
+    result.bears = counts.of(BearType);
+    result.dead = counts.dead;
+
+    std::uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    auto xs = world->x_data();
+    auto ys = world->y_data();
+    auto alive = world->alive_data();
+    hash_bytes(h, xs.data(), xs.size_bytes());
+    hash_bytes(h, ys.data(), ys.size_bytes());
+    hash_bytes(h, alive.data(), alive.size_bytes());
+    result.checksum = h;
+    return result;
+}
@@ -0,0 +1,178 @@
+#include "../include/snapshot.h"
+#include "../include/npc_registry.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+// Смещения секций от начала файла
+struct Layout {
+    size_t type, alive, x, y, name, offsets, bytes, total;
+};
+
+Layout layout_of(const SnapshotHeader &h) {
+    Layout l;
+    l.type = align8(sizeof(SnapshotHeader));
+    l.alive = align8(l.type + h.count);
+    l.x = align8(l.alive + h.count);
+    l.y = align8(l.x + h.count * sizeof(std::int32_t));
+    l.name = align8(l.y + h.count * sizeof(std::int32_t));
+    l.offsets = align8(l.name + h.count * sizeof(std::uint32_t));
+    l.bytes = align8(l.offsets + (h.names + 1) * sizeof(std::uint32_t));
+    l.total = l.bytes + h.names_bytes;
+    return l;
+}
+
+void write_at(std::ofstream &os, size_t offset, const void *data, size_t size) {
+    // Добиваем нулями до начала секции
+    static const char zeros[8] = {};
+    size_t pos = static_cast<size_t>(os.tellp());
+    os.write(zeros, offset - pos);
+    os.write(static_cast<const char *>(data), size);
+}
+
+}
+
+bool save_snapshot(const World &world, const std::string &path) {
+    const NameTable &names = world.name_table();
+    const size_t name_count = names.size();
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(name_count + 1);
+    std::uint32_t bytes = 0;
+    for (std::uint32_t i = 0; i < name_count; ++i) {
+        offsets.push_back(bytes);
+        bytes += static_cast<std::uint32_t>(names.view(i).size());
+    }
+    offsets.push_back(bytes);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.max_x = world.max_x();
+    header.max_y = world.max_y();
+    header.count = world.size();
+    header.names = name_count;
+    header.names_bytes = bytes;
+    Layout l = layout_of(header);
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) {
+        std::cerr << "cannot open snapshot for writing: " << path << std::endl;
+        return false;
+    }
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    write_at(os, l.type, world.type_data().data(), world.size());
+    write_at(os, l.alive, world.alive_data().data(), world.size());
+    write_at(os, l.x, world.x_data().data(), world.size() * sizeof(std::int32_t));
+    write_at(os, l.y, world.y_data().data(), world.size() * sizeof(std::int32_t));
+    write_at(os, l.name, world.name_data().data(), world.size() * sizeof(std::uint32_t));
+    write_at(os, l.offsets, offsets.data(), offsets.size() * sizeof(std::uint32_t));
+    write_at(os, l.bytes, nullptr, 0);
+    for (std::uint32_t i = 0; i < name_count; ++i)
+        os.write(names.view(i).data(), names.view(i).size());
+    return static_cast<bool>(os);
+}
+
+std::unique_ptr<World> load_snapshot(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "cannot open snapshot: " << path << std::endl;
+        return nullptr;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        std::cerr << "snapshot is too short: " << path << std::endl;
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "cannot map snapshot: " << path << std::endl;
+        return nullptr;
+    }
+
+    const char *base = static_cast<const char *>(mapped);
+    std::unique_ptr<World> world;
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    Layout l = layout_of(header);
+
+    const auto *offsets = reinterpret_cast<const std::uint32_t *>(base + l.offsets);
+    bool valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+        && header.version == SNAPSHOT_VERSION
+        && header.count <= size && header.names <= size && header.names_bytes <= size
+        && l.total <= size;
+    for (std::uint64_t i = 0; valid && i < header.names; ++i)
+        valid = offsets[i] <= offsets[i + 1] && offsets[i + 1] <= header.names_bytes;
+
+    if (valid) {
+        size_t n = header.count;
+        auto name_column = std::span(reinterpret_cast<const std::uint32_t *>(base + l.name), n);
+        for (size_t i = 0; valid && i < n; ++i)
+            valid = name_column[i] < header.names;
+
+        if (valid) {
+            // Имена смотрят прямо в отображение; копирует их только таблица мира
+            std::vector<std::string_view> names;
+            names.reserve(header.names);
+            const char *bytes = base + l.bytes;
+            for (std::uint64_t i = 0; i < header.names; ++i)
+                names.emplace_back(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+
+            world = std::make_unique<World>(header.max_x, header.max_y);
+            world->assign(std::span(reinterpret_cast<const std::uint8_t *>(base + l.type), n),
+                          std::span(reinterpret_cast<const int *>(base + l.x), n),
+                          std::span(reinterpret_cast<const int *>(base + l.y), n),
+                          std::span(reinterpret_cast<const std::uint8_t *>(base + l.alive), n),
+                          name_column,
+                          names);
+        }
+    }
+    if (!valid)
+        std::cerr << "corrupted or unsupported snapshot: " << path << std::endl;
+
+    ::munmap(mapped, size);
+    return world;
+}
+
+void save_text(const World &world, std::ostream &os) {
+    // В тексте нет флага жизни: load_text родит каждую запись живой,
+    // поэтому убитые, но ещё не похороненные не пишутся
+    for (EntityId id = 0; id < world.size(); ++id) {
+        if (!world.is_alive(id))
+            continue;
+        os << world.type(id) << '\n'
+           << world.x(id) << '\n'
+           << world.y(id) << '\n'
+           << world.name(id) << '\n';
+    }
+}
+
+size_t load_text(World &world, std::istream &is) {
+    size_t loaded = 0;
+    int type{0};
+    while (is >> type) {
+        int x{0}, y{0};
+        std::string name;
+        is >> x >> y;
+        std::getline(is >> std::ws, name);
+        if (!is || type <= Unknown || static_cast<size_t>(type) >= npc_registry().size()) {
+            std::cerr << "unexpected NPC type:" << type << std::endl;
+            break;
+        }
+        world.spawn(static_cast<NpcType>(type), x, y, name);
+        ++loaded;
+    }
+    return loaded;
+}
@@ -0,0 +1,70 @@
+#include "../include/spatial_grid.h"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(int max_x, int max_y, int cell_size)
+    : cell(std::max(cell_size, 1)),
+      cells_x(std::max(max_x, 0) / cell + 1),
+      cells_y(std::max(max_y, 0) / cell + 1),
+      cells(static_cast<size_t>(cells_x) * cells_y) {}
+
+SpatialGrid::SpatialGrid(const MapArea &area, int cell_size)
+    : SpatialGrid(area.max_x - area.min_x, area.max_y - area.min_y, cell_size) {
+    origin_x = area.min_x;
+    origin_y = area.min_y;
+}
+
+size_t SpatialGrid::cell_index(int x, int y) const {
+    // Точки за границей карты прижимаем к крайним ячейкам
+    int cx = std::clamp((x - origin_x) / cell, 0, cells_x - 1);
+    int cy = std::clamp((y - origin_y) / cell, 0, cells_y - 1);
+    return static_cast<size_t>(cx) + static_cast<size_t>(cy) * cells_x;
+}
+
+void SpatialGrid::clear() {
+    for (auto &c : cells)
+        c.clear();
+    count = 0;
+}
+
+void SpatialGrid::insert(id_t id, int x, int y) {
+    cells[cell_index(x, y)].push_back(id);
+    ++count;
+}
+
+bool SpatialGrid::remove(id_t id, int x, int y) {
+    auto &c = cells[cell_index(x, y)];
+    auto it = std::find(c.begin(), c.end(), id);
+    if (it == c.end())
+        return false;
+    *it = c.back();
+    c.pop_back();
+    --count;
+    return true;
+}
+
+size_t SpatialGrid::remove_sorted(std::span<const id_t> sorted, std::span<const int> xs, std::span<const int> ys) {
+    if (sorted.empty())
+        return 0;
+    std::vector<size_t> touched;
+    touched.reserve(sorted.size());
+    for (id_t id : sorted)
+        touched.push_back(cell_index(xs[id], ys[id]));
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    size_t removed = 0;
+    for (size_t index : touched) {
+        removed += std::erase_if(cells[index], [sorted](id_t id) {
+            return std::binary_search(sorted.begin(), sorted.end(), id);
+        });
+    }
+    count -= removed;
+    return removed;
+}
+
+void SpatialGrid::update(id_t id, int old_x, int old_y, int new_x, int new_y) {
+    if (cell_index(old_x, old_y) == cell_index(new_x, new_y))
+        return;
+    if (remove(id, old_x, old_y))
+        insert(id, new_x, new_y);
+}
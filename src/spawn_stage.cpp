@@ -0,0 +1,64 @@
+#include "../include/spawn_stage.h"
+#include "../include/rng.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Ниже стрима расселения (~0): id сущностей 32-битные, такты до 2^63
+    constexpr std::uint64_t STREAM_SPAWN_TICKS = ~std::uint64_t(0) >> 1;
+}
+
+SpawnStage::SpawnStage(std::uint64_t s, std::span<const SpawnRate> r, size_t population_cap)
+    : seed(s), cap(population_cap) {
+    for (const SpawnRate &rate : r) {
+        if (rate.type != Unknown && rate.per_tick > 0)
+            rates.push_back(rate);
+    }
+    counts.resize(rates.size());
+}
+
+size_t SpawnStage::planned(size_t i, size_t tick) const {
+    // Разность накопленных сумм: дробь не теряется и не зависит от истории
+    double rate = rates[i].per_tick;
+    return static_cast<size_t>(std::floor(rate * static_cast<double>(tick + 1)))
+         - static_cast<size_t>(std::floor(rate * static_cast<double>(tick)));
+}
+
+size_t SpawnStage::run(World &world, SpatialGrid &grid, size_t tick) {
+    size_t total = 0;
+    for (size_t i = 0; i < rates.size(); ++i) {
+        counts[i] = planned(i, tick);
+        total += counts[i];
+    }
+    if (cap > 0) {
+        size_t alive = world.population().total_alive();
+        size_t room = alive < cap ? cap - alive : 0;
+        // Урезаем с последних фракций, порядок фракций - порядок в конфиге
+        for (size_t i = rates.size(); i-- > 0 && total > room;) {
+            size_t cut = std::min(counts[i], total - room);
+            counts[i] -= cut;
+            total -= cut;
+        }
+    }
+    if (total == 0)
+        return 0;
+
+    size_t need = world.size() + (total > world.free_slots() ? total - world.free_slots() : 0);
+    if (need > world.capacity())
+        world.reserve(std::max(need, world.capacity() * 2));
+
+    CounterRng rng(seed, STREAM_SPAWN_TICKS + tick);
+    const auto max_x = static_cast<std::uint32_t>(world.max_x());
+    const auto max_y = static_cast<std::uint32_t>(world.max_y());
+    for (size_t i = 0; i < rates.size(); ++i) {
+        const auto &pool = name_pool(rates[i].type);
+        for (size_t k = 0; k < counts[i]; ++k) {
+            int x = static_cast<int>(rng.uniform(max_x));
+            int y = static_cast<int>(rng.uniform(max_y));
+            const auto &name = pool[rng.uniform(static_cast<std::uint32_t>(pool.size()))];
+            EntityId id = world.spawn(rates[i].type, x, y, name);
+            grid.insert(id, x, y);
+        }
+    }
+    return total;
+}
@@ -0,0 +1,52 @@
+#include "../include/tick_scheduler.h"
+#include "../include/metrics.h"
+#include <thread>
+
+TickScheduler::TickScheduler(double ticks_per_second) {
+    set_tick_rate(ticks_per_second);
+}
+
+void TickScheduler::on(TickPhase phase, phase_fn fn) {
+    phases[static_cast<size_t>(phase)].push_back(std::move(fn));
+}
+
+void TickScheduler::set_tick_rate(double ticks_per_second) {
+    rate = ticks_per_second > 0 ? ticks_per_second : 0;
+    if (rate > 0)
+        period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+    else
+        period = {};
+}
+
+static_assert(static_cast<size_t>(MetricTimer::Spawn) == static_cast<size_t>(TickPhase::Spawn));
+
+void TickScheduler::run_tick() {
+    for (size_t p = 0; p < phases.size(); ++p) {
+        if (phases[p].empty())
+            continue;
+        LAB7_TIME(static_cast<MetricTimer>(p));
+        for (auto &fn : phases[p])
+            fn(current);
+    }
+}
+
+size_t TickScheduler::run(size_t max_ticks) {
+    size_t done = 0;
+    auto next = std::chrono::steady_clock::now();
+    while (done < max_ticks && !stop_requested) {
+        run_tick();
+        ++current;
+        ++done;
+
+        if (rate > 0 && done < max_ticks) {
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            if (next > now)
+                std::this_thread::sleep_until(next);
+            else
+                next = now; // отстали - не пытаемся догонять пачкой тактов
+        }
+    }
+    return done;
+}
@@ -0,0 +1,67 @@
+#include "../include/tournament.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+NpcType battle_winner(const SimulationResult &result) {
+    if (result.knights > result.orcs && result.knights > result.bears)
+        return KnightType;
+    if (result.orcs > result.knights && result.orcs > result.bears)
+        return OrcType;
+    if (result.bears > result.knights && result.bears > result.orcs)
+        return BearType;
+    return Unknown;
+}
+
+WinRate wilson_interval(size_t wins, size_t n, double z) {
+    WinRate rate;
+    rate.wins = wins;
+    if (n == 0)
+        return rate;
+
+    double p = static_cast<double>(wins) / n;
+    double z2n = z * z / n;
+    double center = (p + z2n / 2) / (1 + z2n);
+    double half = z * std::sqrt(p * (1 - p) / n + z2n / (4 * n)) / (1 + z2n);
+    rate.rate = p;
+    rate.low = std::max(0.0, center - half);
+    rate.high = std::min(1.0, center + half);
+    return rate;
+}
+
+TournamentResult run_tournament(const TournamentConfig &config) {
+    TournamentResult result;
+    result.battles = config.battles;
+    result.results.resize(config.battles);
+
+    size_t threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(config.battles, 1));
+
+    std::atomic<size_t> next{0};
+    auto worker = [&config, &result, &next] {
+        SimulationConfig battle = config.battle;
+        battle.fight_workers = 1;
+        // Каждый поток пишет только в свои слоты results
+        for (size_t i = next.fetch_add(1); i < config.battles; i = next.fetch_add(1)) {
+            battle.seed = config.first_seed + i;
+            Simulation sim(battle);
+            result.results[i] = sim.run();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    std::array<size_t, NPC_TYPE_COUNT> wins{};
+    for (auto &battle : result.results)
+        wins[battle_winner(battle)]++;
+    result.draws = wins[Unknown];
+    for (NpcType type : {OrcType, KnightType, BearType})
+        result.factions[type] = wilson_interval(wins[type], config.battles, config.z);
+    return result;
+}
@@ -0,0 +1,191 @@
+#include "../include/world.h"
+#include "../include/simd_kernels.h"
+#include "../include/npc_registry.h"
+#include <algorithm>
+
+size_t PopulationCounts::total_alive() const {
+    size_t total = 0;
+    for (size_t n : alive)
+        total += n;
+    return total;
+}
+
+World::World(int max_x, int max_y)
+    : width(max_x), height(max_y), ranges(npc_registry().move_ranges()) {}
+
+size_t World::memory_bytes() const {
+    return sizeof(World)
+        + (xs.capacity() + ys.capacity()) * sizeof(int)
+        + types.capacity() + alive.capacity() + listed.capacity()
+        + (name_ids.capacity() + generations.capacity()) * sizeof(std::uint32_t)
+        + (free_list.capacity() + live.capacity() + last_buried.capacity()) * sizeof(EntityId)
+        + graves.capacity() * sizeof(GraveRecord);
+}
+
+void World::reserve(size_t n) {
+    xs.reserve(n);
+    ys.reserve(n);
+    types.reserve(n);
+    alive.reserve(n);
+    name_ids.reserve(n);
+    generations.reserve(n);
+    live.reserve(n);
+    listed.reserve(n);
+}
+
+EntityId World::spawn(NpcType type, int x, int y, std::string_view name) {
+    std::uint32_t name_id = name.empty() ? names.intern(generate_random_name(type)) : names.intern(name);
+    alive_by_type[type_slot(static_cast<std::uint8_t>(type))].fetch_add(1, std::memory_order_relaxed);
+
+    if (!free_list.empty()) {
+        EntityId id = free_list.back();
+        free_list.pop_back();
+        xs[id] = x;
+        ys[id] = y;
+        types[id] = static_cast<std::uint8_t>(type);
+        alive[id] = 1;
+        name_ids[id] = name_id;
+        if (!listed[id]) {
+            listed[id] = 1;
+            live.push_back(id);
+        }
+        return id;
+    }
+
+    EntityId id = static_cast<EntityId>(xs.size());
+    xs.push_back(x);
+    ys.push_back(y);
+    types.push_back(static_cast<std::uint8_t>(type));
+    alive.push_back(1);
+    name_ids.push_back(name_id);
+    generations.push_back(0);
+    listed.push_back(1);
+    live.push_back(id);
+    return id;
+}
+
+bool World::release(EntityId id) {
+    if (alive[id] || is_free(id))
+        return false;
+    types[id] = Unknown;
+    ++generations[id];
+    free_list.push_back(id);
+    dead_total.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void World::assign(std::span<const std::uint8_t> type_column,
+                   std::span<const int> x_column,
+                   std::span<const int> y_column,
+                   std::span<const std::uint8_t> alive_column,
+                   std::span<const std::uint32_t> name_column,
+                   std::span<const std::string_view> name_table) {
+    types.assign(type_column.begin(), type_column.end());
+    xs.assign(x_column.begin(), x_column.end());
+    ys.assign(y_column.begin(), y_column.end());
+    alive.assign(alive_column.begin(), alive_column.end());
+    name_ids.assign(name_column.begin(), name_column.end());
+    names.assign(name_table);
+
+    generations.assign(types.size(), 0);
+    free_list.clear();
+    live.clear();
+    listed.assign(types.size(), 0);
+    last_buried.clear();
+    graves.clear();
+
+    std::array<size_t, MAX_NPC_TYPES> counts{};
+    size_t dead = 0;
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (is_free(static_cast<EntityId>(i))) {
+            free_list.push_back(static_cast<EntityId>(i));
+            continue;
+        }
+        // Мёртвые из снимка похоронит первый compact()
+        live.push_back(static_cast<EntityId>(i));
+        listed[i] = 1;
+        if (alive[i])
+            counts[type_slot(types[i])]++;
+        else
+            dead++;
+    }
+    for (size_t t = 0; t < MAX_NPC_TYPES; ++t)
+        alive_by_type[t].store(counts[t], std::memory_order_relaxed);
+    dead_total.store(dead, std::memory_order_relaxed);
+}
+
+size_t World::compact(std::uint32_t tick) {
+    last_buried.clear();
+    size_t kept = 0;
+    for (EntityId id : live) {
+        if (alive[id]) {
+            live[kept++] = id;
+            continue;
+        }
+        listed[id] = 0;
+        if (is_free(id)) // уже освобождён release()
+            continue;
+        graves.push_back({name_ids[id], xs[id], ys[id], tick, types[id]});
+        last_buried.push_back(id);
+        // Как release(), но мёртвый остаётся в dead_count()
+        types[id] = Unknown;
+        ++generations[id];
+        free_list.push_back(id);
+    }
+    live.resize(kept);
+    std::sort(last_buried.begin(), last_buried.end());
+    return last_buried.size();
+}
+
+void World::kill(EntityId id) {
+    if (!alive[id])
+        return;
+    alive[id] = 0;
+    alive_by_type[type_slot(types[id])].fetch_sub(1, std::memory_order_relaxed);
+    dead_total.fetch_add(1, std::memory_order_relaxed);
+}
+
+PopulationCounts World::population() const {
+    PopulationCounts counts;
+    for (size_t t = 0; t < MAX_NPC_TYPES; ++t)
+        counts.alive[t] = alive_by_type[t].load(std::memory_order_relaxed);
+    counts.dead = dead_total.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void World::move(EntityId id, int shift_x, int shift_y) {
+    if (!alive[id]) return;
+
+    int distance = types[id] < ranges.size() ? ranges[types[id]] : 0;
+    shift_x = (shift_x >= 0) ? distance : -distance;
+    shift_y = (shift_y >= 0) ? distance : -distance;
+
+    if ((xs[id] + shift_x >= 0) && (xs[id] + shift_x <= width))
+        xs[id] += shift_x;
+    if ((ys[id] + shift_y >= 0) && (ys[id] + shift_y <= height))
+        ys[id] += shift_y;
+}
+
+void World::move_all(std::span<const std::uint8_t> dirs) {
+    size_t n = std::min(dirs.size(), xs.size());
+    move_batch({xs.data(), ys.data(), types.data(), alive.data(), dirs.data(), ranges, n}, width, height);
+}
+
+bool World::is_close(EntityId a, EntityId b, int distance) const {
+    long long dx = static_cast<long long>(xs[a]) - xs[b];
+    long long dy = static_cast<long long>(ys[a]) - ys[b];
+    return dx * dx + dy * dy <= static_cast<long long>(distance) * distance;
+}
+
+std::ostream &print_entity(std::ostream &os, const World &world, EntityId id) {
+    os << type_name(world.type(id)) << " " << world.name(id) << ": "
+       << "{ x:" << world.x(id) << ", y:" << world.y(id) << ", name:\"" << world.name(id) << "\"} " << '\n';
+    return os;
+}
+
+std::ostream &print_grave(std::ostream &os, const World &world, const GraveRecord &grave) {
+    std::string_view name = world.name_table().view(grave.name_id);
+    os << type_name(static_cast<NpcType>(grave.type)) << " " << name << ": "
+       << "{ x:" << grave.x << ", y:" << grave.y << ", name:\"" << name << "\"} " << '\n';
+    return os;
+}
@@ -4,6 +4,34 @@
 #include "../include/orc.h"
 #include "../include/bear.h"
 #include "../include/npc.h"
+#include "../include/spatial_grid.h"
+#include "../include/world.h"
+#include "../include/fight_table.h"
+#include "../include/fight_manager.h"
+#include "../include/mpsc_queue.h"
+#include "../include/region_fights.h"
+#include "../include/tick_scheduler.h"
+#include "../include/async_logger.h"
+#include "../include/snapshot.h"
+#include "../include/event_bus.h"
+#include "../include/rng.h"
+#include "../include/simulation.h"
+#include "../include/tournament.h"
+#include "../include/population_history.h"
+#include "../include/frame_renderer.h"
+#include "../include/name_table.h"
+#include "../include/simd_kernels.h"
+#include "../include/config_file.h"
+#include "../include/npc_registry.h"
+#include "../include/metrics.h"
+#include "../include/fight_candidates.h"
+#include "../include/spawn_stage.h"
+#include "../include/chunked_world.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <sstream>
+#include <thread>
 
 TEST(KnightTests, Test_01_Print) {
     Knight knight(30, 60);
@@ -168,7 +196,1580 @@ TEST(NPCTests, Test_02_Survivors) {
         n->print();
 }
 
+TEST(SpatialGridTests, Test_01_SameAsBruteForce) {
+    const int max_xy = 200, distance = 10;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> coord(0, max_xy);
+    std::vector<std::pair<int, int>> points(500);
+    for (auto &p : points)
+        p = {coord(gen), coord(gen)};
+
+    SpatialGrid grid(max_xy, max_xy, distance);
+    for (SpatialGrid::id_t id = 0; id < points.size(); ++id)
+        grid.insert(id, points[id].first, points[id].second);
+
+    auto close = [&](size_t a, size_t b) {
+        int dx = points[a].first - points[b].first;
+        int dy = points[a].second - points[b].second;
+        return dx * dx + dy * dy <= distance * distance;
+    };
+
+    std::set<std::pair<size_t, size_t>> expected, found;
+    for (size_t a = 0; a < points.size(); ++a)
+        for (size_t b = a + 1; b < points.size(); ++b)
+            if (close(a, b))
+                expected.insert({a, b});
+
+    grid.for_each_candidate_pair([&](SpatialGrid::id_t a, SpatialGrid::id_t b) {
+        if (close(a, b)) {
+            ASSERT_TRUE(found.insert({std::min(a, b), std::max(a, b)}).second);
+        }
+    });
+
+    ASSERT_EQ(expected, found);
+}
+
+TEST(SpatialGridTests, Test_02_Update) {
+    SpatialGrid grid(100, 100, 10);
+    grid.insert(0, 5, 5);
+    grid.insert(1, 95, 95);
+
+    size_t pairs = 0;
+    grid.for_each_candidate_pair([&](SpatialGrid::id_t, SpatialGrid::id_t) { ++pairs; });
+    ASSERT_EQ(pairs, 0u);
+
+    grid.update(1, 95, 95, 12, 8);
+    grid.for_each_candidate_pair([&](SpatialGrid::id_t, SpatialGrid::id_t) { ++pairs; });
+    ASSERT_EQ(pairs, 1u);
+    ASSERT_EQ(grid.size(), 2u);
+
+    ASSERT_TRUE(grid.remove(0, 5, 5));
+    ASSERT_FALSE(grid.remove(0, 5, 5));
+    ASSERT_EQ(grid.size(), 1u);
+}
+
+TEST(WorldTests, Test_01_Spawn) {
+    World world(500, 500);
+    EntityId a = world.spawn(OrcType, 10, 20, "Grom");
+    EntityId b = world.spawn(KnightType, 30, 40, "Arthur");
+    EntityId c = world.spawn(OrcType, 50, 60, "Grom");
+
+    ASSERT_EQ(world.size(), 3u);
+    ASSERT_EQ(world.position(b), std::make_pair(30, 40));
+    ASSERT_EQ(world.type(c), OrcType);
+    ASSERT_EQ(world.name(a), "Grom");
+    // Одинаковые имена хранятся один раз
+    ASSERT_EQ(world.name_table().size(), 2u);
+    ASSERT_EQ(world.name_data()[a], world.name_data()[c]);
+
+    world.kill(b);
+    ASSERT_FALSE(world.is_alive(b));
+    ASSERT_TRUE(world.is_alive(a));
+}
+
+TEST(WorldTests, Test_02_MoveLikeNPC) {
+    World world(500, 500);
+    Orc orc(490, 5);
+    Bear bear(100, 100);
+    EntityId o = world.spawn(OrcType, 490, 5);
+    EntityId b = world.spawn(BearType, 100, 100);
+
+    for (int shift : {3, -4, 7, -1, 0}) {
+        orc.move(shift, -shift, 500, 500);
+        bear.move(-shift, shift, 500, 500);
+        world.move(o, shift, -shift);
+        world.move(b, -shift, shift);
+        ASSERT_EQ(world.position(o), orc.position());
+        ASSERT_EQ(world.position(b), bear.position());
+    }
+}
+
+TEST(WorldTests, Test_03_HandleView) {
+    World world(500, 500);
+    auto knight = std::make_shared<Knight>(world, world.spawn(KnightType, 30, 60, "Lancelot"));
+    auto orc = std::make_shared<Orc>(world, world.spawn(OrcType, 35, 62, "Mog"));
+
+    ASSERT_EQ(knight->get_name(), "Lancelot");
+    ASSERT_TRUE(knight->is_close(orc, 10));
+    ASSERT_TRUE(orc->accept(knight));
+
+    orc->must_die();
+    ASSERT_FALSE(world.is_alive(orc->entity()));
+    ASSERT_FALSE(orc->is_alive());
+    // Слот занят заново - view видит имя нового жильца
+    world.release(orc->entity());
+    ASSERT_EQ(world.spawn(OrcType, 35, 62, "Grom"), orc->entity());
+    ASSERT_EQ(orc->get_name(), "Grom");
+
+    knight->move(1, 1, 500, 500);
+    ASSERT_EQ(world.position(knight->entity()), std::make_pair(60, 90));
+    knight->print();
+}
+
+TEST(WorldTests, Test_04_ReleaseReusesSlot) {
+    World world(100, 100);
+    EntityId a = world.spawn(OrcType, 1, 1, "Grom");
+    EntityId b = world.spawn(BearType, 2, 2, "Baloo");
+    EntityHandle old = world.handle(b);
+
+    ASSERT_FALSE(world.release(b)); // живых не освобождаем
+    world.kill(b);
+    ASSERT_EQ(world.dead_count(), 1u);
+    ASSERT_TRUE(world.release(b));
+    ASSERT_FALSE(world.release(b));
+    ASSERT_TRUE(world.is_free(b));
+    ASSERT_EQ(world.dead_count(), 0u);
+    ASSERT_EQ(world.free_slots(), 1u);
+
+    EntityId c = world.spawn(KnightType, 3, 4, "Arthur");
+    ASSERT_EQ(c, b);
+    ASSERT_EQ(world.size(), 2u);
+    ASSERT_EQ(world.free_slots(), 0u);
+    ASSERT_FALSE(world.is_valid(old));
+    ASSERT_EQ(world.handle(c).generation, old.generation + 1);
+    ASSERT_EQ(world.name(c), "Arthur");
+    ASSERT_EQ(world.position(c), std::make_pair(3, 4));
+    ASSERT_EQ(world.alive_count(KnightType), 1u);
+    ASSERT_EQ(world.alive_count(BearType), 0u);
+
+    // Свободный слот переживает снимок и снова занимается
+    world.kill(a);
+    world.release(a);
+    auto path = (std::filesystem::temp_directory_path() / "lab7_release_test.l7ws").string();
+    ASSERT_TRUE(save_snapshot(world, path));
+    auto loaded = load_snapshot(path);
+    std::filesystem::remove(path);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(loaded->free_slots(), 1u);
+    ASSERT_EQ(loaded->dead_count(), 0u);
+    ASSERT_EQ(loaded->spawn(OrcType, 0, 0, "Mog"), a);
+}
+
+TEST(WorldTests, Test_05_CompactBuriesDead) {
+    World world(100, 100);
+    EntityId a = world.spawn(OrcType, 1, 1, "Grom");
+    EntityId b = world.spawn(BearType, 2, 2, "Baloo");
+    EntityId c = world.spawn(KnightType, 3, 3, "Arthur");
+    EntityId d = world.spawn(OrcType, 4, 4, "Mog");
+    world.kill(d);
+    world.kill(b);
+    world.release(d); // освобождённый вручную в кладбище не попадает
+
+    ASSERT_EQ(world.compact(7), 1u);
+    ASSERT_EQ(std::vector<EntityId>(world.buried().begin(), world.buried().end()), std::vector<EntityId>{b});
+    ASSERT_EQ(std::vector<EntityId>(world.live_ids().begin(), world.live_ids().end()),
+              (std::vector<EntityId>{a, c}));
+    ASSERT_TRUE(world.is_free(b));
+    ASSERT_EQ(world.dead_count(), 1u); // похороненный остаётся в счёте мёртвых
+    ASSERT_EQ(world.graveyard().size(), 1u);
+    const GraveRecord &grave = world.graveyard()[0];
+    ASSERT_EQ(grave.type, BearType);
+    ASSERT_EQ(grave.tick, 7u);
+    ASSERT_EQ(world.name_table().view(grave.name_id), "Baloo");
+    std::ostringstream os;
+    print_grave(os, world, grave);
+    ASSERT_EQ(os.str(), "Bear Baloo: { x:2, y:2, name:\"Baloo\"} \n");
+
+    // Слоты переиспользуются, и каждый id в live_ids() один раз
+    EntityId e = world.spawn(KnightType, 5, 5, "Lancelot");
+    EntityId f = world.spawn(KnightType, 6, 6, "Gawain");
+    ASSERT_EQ(std::min(e, f), b);
+    ASSERT_EQ(std::max(e, f), d);
+    ASSERT_EQ(world.live_ids().size(), 4u);
+    ASSERT_EQ(world.compact(8), 0u);
+    ASSERT_EQ(world.live_ids().size(), 4u);
+    ASSERT_EQ(world.size(), 4u);
+}
+
+std::shared_ptr<NPC> make_npc(NpcType type, int x, int y) {
+    switch (type) {
+        case OrcType: return std::make_shared<Orc>(x, y);
+        case KnightType: return std::make_shared<Knight>(x, y);
+        case BearType: return std::make_shared<Bear>(x, y);
+        default: return nullptr;
+    }
+}
+
+TEST(FightTableTests, Test_01_AgreesWithVisitor) {
+    for (NpcType attacker_type : {OrcType, KnightType, BearType}) {
+        for (NpcType defender_type : {OrcType, KnightType, BearType}) {
+            auto attacker = make_npc(attacker_type, 0, 0);
+            auto defender = make_npc(defender_type, 0, 0);
+            ASSERT_EQ(defender->accept(attacker), resolve_fight(attacker_type, defender_type))
+                << "attacker " << attacker_type << " defender " << defender_type;
+        }
+    }
+}
+
+TEST(FightTableTests, Test_02_Batch) {
+    World world(100, 100);
+    EntityHandle knight = world.handle(world.spawn(KnightType, 0, 0, "Arthur"));
+    EntityHandle orc = world.handle(world.spawn(OrcType, 0, 0, "Grom"));
+    EntityHandle bear = world.handle(world.spawn(BearType, 0, 0, "Baloo"));
+
+    // Медведь убивает рыцаря, и тот уже не может убить орка
+    std::vector<FightEvent> batch{{bear, knight}, {knight, orc}, {orc, bear}};
+    FightManager manager(world);
+    ASSERT_EQ(manager.resolve_batch(batch), 2u);
+    ASSERT_FALSE(world.is_alive(knight.id));
+    ASSERT_TRUE(world.is_alive(orc.id));
+    ASSERT_FALSE(world.is_alive(bear.id));
+
+    manager.add_event({orc, world.handle(world.spawn(BearType, 0, 0, "Yogi"))});
+    ASSERT_EQ(manager.drain(), 1u);
+    ASSERT_EQ(manager.drain(), 0u);
+}
+
+TEST(MpscQueueTests, Test_01_Bounded) {
+    MpscQueue<int> queue(3);
+    ASSERT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(queue.try_push(int(i)));
+    ASSERT_FALSE(queue.try_push(4));
+
+    int value = -1;
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ(value, 0);
+    ASSERT_TRUE(queue.try_push(4));
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(MpscQueueTests, Test_02_ManyProducers) {
+    MpscQueue<int> queue(64);
+    const int producers = 4, items = 10000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < items; ++i)
+                while (!queue.try_push(p * items + i))
+                    std::this_thread::yield();
+        });
+
+    // От каждого производителя значения приходят по порядку
+    std::vector<int> last(producers, -1);
+    int received = 0, value = 0;
+    while (received < producers * items) {
+        if (!queue.try_pop(value))
+            continue;
+        int p = value / items;
+        ASSERT_GT(value % items, last[p]);
+        last[p] = value % items;
+        ++received;
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+TEST(FightManagerTests, Test_01_WakesOnEvent) {
+    World world(100, 100);
+    auto knight = std::make_shared<Knight>(world, world.spawn(KnightType, 0, 0, "Arthur"));
+    auto orc = std::make_shared<Orc>(world, world.spawn(OrcType, 0, 0, "Grom"));
+
+    FightManager manager(world);
+    std::thread fight_thread(std::ref(manager));
+    manager.add_event({world.handle(knight->entity()), world.handle(orc->entity())});
+    for (int i = 0; i < 1000 && orc->is_alive(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    manager.stop();
+    fight_thread.join();
+
+    ASSERT_FALSE(orc->is_alive());
+}
+
+TEST(FightManagerTests, Test_02_StaleHandleSkipped) {
+    World world(100, 100);
+    EntityHandle knight = world.handle(world.spawn(KnightType, 0, 0, "Arthur"));
+    EntityHandle orc = world.handle(world.spawn(OrcType, 0, 0, "Grom"));
+    world.kill(orc.id);
+    ASSERT_TRUE(world.release(orc.id));
+
+    // Слот орка занял новый орк, старое событие его не убивает
+    EntityId reused = world.spawn(OrcType, 0, 0, "Mog");
+    ASSERT_EQ(reused, orc.id);
+    ASSERT_FALSE(world.is_valid(orc));
+    ASSERT_TRUE(world.is_valid(world.handle(reused)));
+
+    FightManager manager(world);
+    std::vector<FightEvent> batch{{knight, orc}};
+    ASSERT_EQ(manager.resolve_batch(batch), 0u);
+    ASSERT_TRUE(world.is_alive(reused));
+
+    manager.set_parallel(2);
+    batch.push_back({knight, world.handle(reused)});
+    ASSERT_EQ(manager.resolve_batch(batch), 1u);
+    ASSERT_FALSE(world.is_alive(reused));
+}
+
+TEST(FightManagerTests, Test_03_CandidatesDeduplicated) {
+    World world(100, 100);
+    EntityId orc = world.spawn(OrcType, 0, 0, "Grom");
+    EntityId knight = world.spawn(KnightType, 0, 0, "Arthur");
+    EntityId bear = world.spawn(BearType, 0, 0, "Baloo");
+    EntityId orc2 = world.spawn(OrcType, 0, 0, "Mog");
+
+    // Атакует победитель по матрице, при равенстве - меньший id
+    FightPair p = canonical_fight(world, orc, knight);
+    ASSERT_EQ(p.attacker, knight);
+    ASSERT_EQ(p.defender, orc);
+    p = canonical_fight(world, orc2, orc);
+    ASSERT_EQ(p.attacker, orc);
+    ASSERT_EQ(p.defender, orc2);
+
+    FightManager manager(world);
+    ASSERT_TRUE(manager.add_candidate(orc, knight));
+    ASSERT_FALSE(manager.add_candidate(knight, orc)); // та же пара в обратном порядке
+    ASSERT_FALSE(manager.add_candidate(orc, knight));
+    ASSERT_TRUE(manager.add_candidate(bear, orc));
+    ASSERT_EQ(manager.in_flight_pairs(), 2u);
+
+    // Орк погибает от рыцаря; бой орка с медведем уже без участника
+    ASSERT_EQ(manager.drain(), 1u);
+    ASSERT_FALSE(world.is_alive(orc));
+    ASSERT_TRUE(world.is_alive(bear));
+    ASSERT_EQ(manager.in_flight_pairs(), 0u);
+    // После разбора пару снова можно поставить
+    ASSERT_TRUE(manager.add_candidate(knight, bear));
+    ASSERT_EQ(manager.drain(), 1u);
+    ASSERT_FALSE(world.is_alive(knight));
+}
+
+TEST(FightManagerTests, Test_04_InFlightPairsBounded) {
+    InFlightPairs pairs(64);
+    std::vector<bool> added(1000);
+    size_t full = 0;
+    for (EntityId i = 0; i < 1000; ++i) {
+        auto result = pairs.insert({i, 0}, {i + 1, 0});
+        added[i] = result == InFlightPairs::Insert::Added;
+        full += result == InFlightPairs::Insert::Full;
+    }
+    size_t count = std::count(added.begin(), added.end(), true);
+    ASSERT_EQ(count + full, 1000u);
+    ASSERT_EQ(pairs.size(), count);
+    ASSERT_LE(count, pairs.capacity());
+    ASSERT_GE(count, 64u);
+
+    // Удаление со сдвигом сохраняет цепочки: оставшиеся пары находятся
+    for (EntityId i = 0; i < 1000; i += 2)
+        pairs.erase({i, 0}, {i + 1, 0});
+    for (EntityId i = 1; i < 1000; i += 2) {
+        if (added[i]) {
+            ASSERT_EQ(pairs.insert({i + 1, 0}, {i, 0}), InFlightPairs::Insert::Duplicate) << i;
+        }
+    }
+    for (EntityId i = 0; i < 1000; ++i)
+        pairs.erase({i, 0}, {i + 1, 0});
+    ASSERT_EQ(pairs.size(), 0u);
+    const EntityId max = std::numeric_limits<EntityId>::max();
+    ASSERT_EQ(pairs.insert({max - 1, max}, {max, max}), InFlightPairs::Insert::Added);
+}
+
+TEST(FightManagerTests, Test_05_ReusedSlotIsNewPair) {
+    World world(100, 100);
+    EntityId orc = world.spawn(OrcType, 0, 0, "Grom");
+    EntityId knight = world.spawn(KnightType, 50, 50, "Arthur");
+    FightManager manager(world);
+    ASSERT_TRUE(manager.add_candidate(orc, knight));
+
+    // Рыцарь погиб в другом бою, его слот занял медведь: пара уже другая
+    world.kill(knight);
+    ASSERT_TRUE(world.release(knight));
+    ASSERT_EQ(world.spawn(BearType, 0, 0, "Baloo"), knight);
+    ASSERT_TRUE(manager.add_candidate(knight, orc));
+    ASSERT_FALSE(manager.add_candidate(orc, knight));
+    ASSERT_EQ(manager.in_flight_pairs(), 2u);
+
+    // Событие про погибшего рыцаря пропускается, медведь гибнет от орка
+    ASSERT_EQ(manager.drain(), 1u);
+    ASSERT_FALSE(world.is_alive(knight));
+    ASSERT_EQ(manager.in_flight_pairs(), 0u);
+}
+
+TEST(RegionFightTests, Test_01_LocalFightsLikeSequential) {
+    // Четыре региона по 100 клеток, все бои внутри своих регионов
+    World world(399, 399);
+    std::vector<FightPair> fights;
+    for (int r = 0; r < 4; ++r) {
+        EntityId knight = world.spawn(KnightType, r * 100 + 10, 10);
+        EntityId orc = world.spawn(OrcType, r * 100 + 15, 10);
+        EntityId bear = world.spawn(BearType, r * 100 + 20, 10);
+        fights.push_back({bear, knight});
+        fights.push_back({knight, orc});
+        fights.push_back({orc, bear});
+    }
+
+    RegionFightResolver resolver(world, 4);
+    auto outcomes = resolver.resolve(fights);
+
+    ASSERT_EQ(outcomes.size(), 8u);
+    for (EntityId id = 0; id < world.size(); ++id)
+        ASSERT_EQ(world.is_alive(id), world.type(id) == OrcType);
+    for (size_t i = 1; i < outcomes.size(); ++i)
+        ASSERT_LT(outcomes[i - 1].event, outcomes[i].event);
+}
+
+TEST(RegionFightTests, Test_02_Deterministic) {
+    auto run = [](size_t workers) {
+        World world(999, 999);
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<> coord(0, 999);
+        for (int i = 0; i < 3000; ++i)
+            world.spawn(static_cast<NpcType>(OrcType + i % 3), coord(gen), coord(gen), "N");
+        std::vector<FightPair> fights;
+        for (EntityId a = 0; a < world.size(); ++a)
+            for (EntityId b = 0; b < world.size(); ++b)
+                if (a != b && world.is_close(a, b, 30))
+                    fights.push_back({a, b});
+
+        RegionFightResolver resolver(world, workers);
+        auto outcomes = resolver.resolve(fights);
+        std::vector<std::pair<size_t, bool>> result;
+        for (auto &o : outcomes)
+            result.push_back({o.event, o.win});
+        for (EntityId id = 0; id < world.size(); ++id)
+            result.push_back({id, world.is_alive(id)});
+        return result;
+    };
+
+    ASSERT_EQ(run(4), run(4));
+    ASSERT_EQ(run(1), run(1));
+}
+
+TEST(TickSchedulerTests, Test_01_PhaseOrder) {
+    TickScheduler scheduler(0);
+    std::string trace;
+    // Регистрируем не по порядку: выполняться фазы должны по порядку
+    scheduler.on(TickPhase::Render, [&](size_t) { trace += 'R'; });
+    scheduler.on(TickPhase::Fight, [&](size_t) { trace += 'F'; });
+    scheduler.on(TickPhase::Move, [&](size_t) { trace += 'M'; });
+    scheduler.on(TickPhase::Observe, [&](size_t) { trace += 'O'; });
+    scheduler.on(TickPhase::Detect, [&](size_t) { trace += 'D'; });
+
+    ASSERT_EQ(scheduler.run(2), 2u);
+    ASSERT_EQ(trace, "MDFORMDFOR");
+    ASSERT_EQ(scheduler.tick(), 2u);
+}
+
+TEST(TickSchedulerTests, Test_02_StopAndRate) {
+    TickScheduler scheduler(0);
+    scheduler.on(TickPhase::Move, [&](size_t tick) {
+        if (tick == 9)
+            scheduler.request_stop();
+    });
+    ASSERT_EQ(scheduler.run(1000), 10u);
+    ASSERT_EQ(scheduler.run(1000), 0u);
+
+    // 5 тактов при 100 Гц - не меньше 40 мс (между тактами 4 периода)
+    TickScheduler paced(100);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(paced.run(5), 5u);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+}
+
+std::string read_file(const std::filesystem::path &path) {
+    std::ifstream is(path);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+}
+
+TEST(AsyncLoggerTests, Test_01_DrainOnShutdown) {
+    auto path = std::filesystem::temp_directory_path() / "lab7_async_logger_test.txt";
+    const int threads_count = 4, records = 1000;
+    {
+        AsyncLogger logger(path.string(), false, std::chrono::milliseconds(1000));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threads_count; ++t)
+            threads.emplace_back([&logger, t]() {
+                for (int i = 0; i < records; ++i)
+                    logger.log(std::to_string(t) + " " + std::to_string(i) + "\n");
+            });
+        for (auto &t : threads)
+            t.join();
+    }
+
+    // Всё дописано, а записи каждого потока идут по порядку
+    std::istringstream is(read_file(path));
+    std::vector<int> last(threads_count, -1);
+    int t = 0, i = 0, lines = 0;
+    while (is >> t >> i) {
+        ASSERT_EQ(i, last[t] + 1);
+        last[t] = i;
+        ++lines;
+    }
+    ASSERT_EQ(lines, threads_count * records);
+    std::filesystem::remove(path);
+}
+
+TEST(AsyncLoggerTests, Test_02_FlushBatches) {
+    auto path = std::filesystem::temp_directory_path() / "lab7_async_logger_flush.txt";
+    AsyncLogger logger(path.string(), false, std::chrono::milliseconds(1000));
+    for (int i = 0; i < 100; ++i)
+        logger.log("line\n");
+    logger.flush();
+
+    ASSERT_EQ(read_file(path).size(), 500u);
+    ASSERT_EQ(logger.bytes_written(), 500u);
+    ASSERT_EQ(logger.write_calls(), 1u);
+    std::filesystem::remove(path);
+}
+
+TEST(AsyncLoggerTests, Test_03_DeadLoggersLeaveThreadCache) {
+    auto path = std::filesystem::temp_directory_path() / "lab7_async_logger_cache.txt";
+    std::thread([&path] {
+        // Поток переживает сотню журналов, а кэш держит один-два буфера
+        for (int i = 0; i < 100; ++i) {
+            AsyncLogger logger(path.string());
+            logger.log("x\n");
+            ASSERT_LE(AsyncLogger::thread_cache_size(), 2u);
+        }
+        AsyncLogger a(path.string()), b(path.string());
+        a.log("a\n");
+        b.log("b\n");
+        ASSERT_EQ(AsyncLogger::thread_cache_size(), 2u);
+    }).join();
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotTests, Test_01_BinaryRoundTrip) {
+    World world(300, 200);
+    world.spawn(OrcType, 1, 2, "Grom");
+    world.spawn(KnightType, 299, 0, "Gul'dan");
+    world.spawn(BearType, 150, 200, "Grom");
+    world.kill(1);
+
+    auto path = (std::filesystem::temp_directory_path() / "lab7_snapshot_test.l7ws").string();
+    ASSERT_TRUE(save_snapshot(world, path));
+    auto loaded = load_snapshot(path);
+    ASSERT_NE(loaded, nullptr);
+
+    ASSERT_EQ(loaded->max_x(), 300);
+    ASSERT_EQ(loaded->max_y(), 200);
+    ASSERT_EQ(loaded->size(), world.size());
+    ASSERT_EQ(loaded->name_table().size(), 2u);
+    for (EntityId id = 0; id < world.size(); ++id) {
+        ASSERT_EQ(loaded->position(id), world.position(id));
+        ASSERT_EQ(loaded->type(id), world.type(id));
+        ASSERT_EQ(loaded->is_alive(id), world.is_alive(id));
+        ASSERT_EQ(loaded->name(id), world.name(id));
+    }
+    // Загруженный мир продолжает интернировать имена
+    EntityId id = loaded->spawn(OrcType, 0, 0, "Grom");
+    ASSERT_EQ(loaded->name_data()[id], loaded->name_data()[0]);
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotTests, Test_02_RejectsCorrupted) {
+    auto path = (std::filesystem::temp_directory_path() / "lab7_snapshot_bad.l7ws").string();
+    {
+        std::ofstream os(path, std::ios::binary);
+        os << "not a snapshot at all, just some text long enough";
+    }
+    ASSERT_EQ(load_snapshot(path), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotTests, Test_03_TextCompatibleWithNPC) {
+    std::stringstream ss;
+    Orc orc(10, 20, "Mog");
+    orc.save(ss);
+    Bear bear(30, 40, "Yogi");
+    bear.save(ss);
+
+    World world(500, 500);
+    ASSERT_EQ(load_text(world, ss), 2u);
+    ASSERT_EQ(world.type(1), BearType);
+    ASSERT_EQ(world.position(1), std::make_pair(30, 40));
+    ASSERT_EQ(world.name(0), "Mog");
+
+    std::stringstream out;
+    save_text(world, out);
+    int type = 0;
+    out >> type;
+    Orc copy(out);
+    ASSERT_EQ(type, OrcType);
+    ASSERT_EQ(copy.get_name(), "Mog");
+    ASSERT_EQ(copy.position(), std::make_pair(10, 20));
+}
+
+TEST(SnapshotTests, Test_04_TextSkipsKilled) {
+    World world(500, 500);
+    world.spawn(OrcType, 10, 20, "Mog");
+    EntityId bear = world.spawn(BearType, 30, 40, "Yogi");
+    world.spawn(KnightType, 50, 60, "Arthur");
+    world.kill(bear); // убит, но compact ещё не было
+
+    std::stringstream text;
+    save_text(world, text);
+    World loaded(500, 500);
+    ASSERT_EQ(load_text(loaded, text), 2u);
+    ASSERT_EQ(loaded.alive_count(BearType), 0u);
+    ASSERT_EQ(loaded.name(1), "Arthur");
+    ASSERT_EQ(loaded.dead_count(), 0u);
+}
+
+TEST(NPCStateTests, Test_01_PackedState) {
+    Orc orc(-7, 1000000, "Grom");
+    ASSERT_EQ(orc.position(), std::make_pair(-7, 1000000));
+    ASSERT_TRUE(orc.is_alive());
+    ASSERT_EQ(orc.get_type(), OrcType);
+
+    orc.move(1, -1, 2000000, 2000000);
+    ASSERT_EQ(orc.position(), std::make_pair(13, 999980));
+    orc.must_die();
+    orc.move(1, 1, 2000000, 2000000);
+    ASSERT_FALSE(orc.is_alive());
+    ASSERT_EQ(orc.position(), std::make_pair(13, 999980));
+}
+
+TEST(NPCStateTests, Test_02_ConcurrentMoveAndDie) {
+    // Смерть, наступившая во время перемещения, не теряется
+    for (int round = 0; round < 20; ++round) {
+        auto bear = std::make_shared<Bear>(250, 250, "Yogi");
+        std::atomic<bool> go{false};
+        std::thread mover([&]() {
+            while (!go) {}
+            for (int i = 0; i < 10000; ++i)
+                bear->move(i % 2 ? 1 : -1, i % 2 ? -1 : 1, 500, 500);
+        });
+        std::thread reader([&]() {
+            while (!go) {}
+            for (int i = 0; i < 10000; ++i) {
+                auto [x, y] = bear->position();
+                ASSERT_TRUE(x == 250 || x == 245);
+                ASSERT_TRUE(y == 250 || y == 255);
+            }
+        });
+        go = true;
+        bear->must_die();
+        mover.join();
+        reader.join();
+        ASSERT_FALSE(bear->is_alive());
+    }
+}
+
+class RecordingObserver : public IFightBatchObserver {
+public:
+    std::vector<std::vector<FightRecord>> batches;
+
+    void on_fights(const World &, std::span<const FightRecord> fights) override {
+        batches.emplace_back(fights.begin(), fights.end());
+    }
+};
+
+TEST(EventBusTests, Test_01_FilterBeforeDispatch) {
+    World world(100, 100);
+    EventBus bus;
+    auto all = std::make_shared<RecordingObserver>();
+    auto wins = std::make_shared<RecordingObserver>();
+    bus.subscribe(all);
+    bus.subscribe(wins, FightFilter::WinsOnly);
+
+    bus.publish({0, 1, OrcType, KnightType, false});
+    bus.publish({1, 0, KnightType, OrcType, true});
+    bus.publish({2, 3, OrcType, OrcType, false});
+    ASSERT_EQ(bus.pending(), 3u);
+    ASSERT_EQ(bus.dispatch(world), 3u);
+    ASSERT_EQ(bus.pending(), 0u);
+
+    ASSERT_EQ(all->batches.size(), 1u);
+    ASSERT_EQ(all->batches[0].size(), 3u);
+    ASSERT_EQ(wins->batches.size(), 1u);
+    ASSERT_EQ(wins->batches[0].size(), 1u);
+    ASSERT_EQ(wins->batches[0][0].attacker, 1u);
+
+    // Только проигрыши - наблюдатель побед не вызывается
+    bus.publish({0, 1, OrcType, KnightType, false});
+    bus.dispatch(world);
+    ASSERT_EQ(all->batches.size(), 2u);
+    ASSERT_EQ(wins->batches.size(), 1u);
+    ASSERT_EQ(bus.dispatch(world), 0u);
+}
+
+TEST(EventBusTests, Test_02_FightManagerPublishes) {
+    World world(100, 100);
+    EventBus bus;
+    auto wins = std::make_shared<RecordingObserver>();
+    bus.subscribe(wins, FightFilter::WinsOnly);
+
+    auto knight = std::make_shared<Knight>(world, world.spawn(KnightType, 10, 10, "Arthur"));
+    auto orc = std::make_shared<Orc>(world, world.spawn(OrcType, 12, 10, "Grom"));
+    EntityHandle k = world.handle(knight->entity()), o = world.handle(orc->entity());
+    std::vector<FightEvent> batch{{o, k}, {k, o}};
+
+    FightManager manager(world);
+    manager.set_event_bus(&bus);
+    ASSERT_EQ(manager.resolve_batch(batch), 1u);
+
+    ASSERT_EQ(bus.pending(), 2u);
+    bus.dispatch(world);
+    ASSERT_EQ(wins->batches.size(), 1u);
+    ASSERT_EQ(wins->batches[0][0].defender, orc->entity());
+    ASSERT_FALSE(world.is_alive(orc->entity()));
+
+    std::ostringstream os;
+    print_entity(os, world, knight->entity());
+    std::ostringstream expected;
+    knight->print(expected);
+    ASSERT_EQ(os.str(), expected.str());
+}
+
+TEST(SimulationTests, Test_01_CounterRngRandomAccess) {
+    CounterRng seq(7, 3);
+    CounterRng other(7, 4);
+    std::vector<std::uint64_t> values;
+    for (int i = 0; i < 8; ++i)
+        values.push_back(seq.next());
+    // Любой элемент можно получить напрямую, в любом порядке
+    for (int i = 7; i >= 0; --i)
+        ASSERT_EQ(CounterRng(7, 3).at(i), values[i]);
+    ASSERT_NE(other.at(0), values[0]);
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_LT(seq.uniform(10), 10u);
+}
+
+TEST(SimulationTests, Test_02_SameSeedSameResult) {
+    SimulationConfig config;
+    config.seed = 12345;
+    config.population = {300, 300, 300};
+    config.max_x = config.max_y = 300;
+    config.ticks = 50;
+
+    Simulation first(config);
+    Simulation second(config);
+    SimulationResult a = first.run();
+    SimulationResult b = second.run();
+    ASSERT_EQ(a.ticks, 50u);
+    ASSERT_GT(a.dead, 0u);
+    ASSERT_EQ(a.checksum, b.checksum);
+    ASSERT_EQ(a.knights, b.knights);
+    ASSERT_EQ(a.orcs, b.orcs);
+    ASSERT_EQ(a.bears, b.bears);
+    for (EntityId id = 0; id < first.get_world().size(); ++id)
+        ASSERT_EQ(first.get_world().name(id), second.get_world().name(id));
+
+    config.seed = 54321;
+    Simulation third(config);
+    ASSERT_NE(third.run().checksum, a.checksum);
+}
+
+TEST(SimulationTests, Test_03_CompactionKeepsOnlyLive) {
+    SimulationConfig config;
+    config.seed = 777;
+    config.population = {300, 300, 300};
+    config.max_x = config.max_y = 300;
+    config.ticks = 40;
+
+    Simulation sim(config);
+    SimulationResult result = sim.run();
+    const World &world = sim.get_world();
+    ASSERT_GT(result.dead, 0u);
+    ASSERT_EQ(world.graveyard().size(), result.dead);
+    ASSERT_EQ(world.live_ids().size(), result.knights + result.orcs + result.bears);
+    for (EntityId id : world.live_ids())
+        ASSERT_TRUE(world.is_alive(id));
+    for (const GraveRecord &grave : world.graveyard())
+        ASSERT_LT(grave.tick, config.ticks);
+}
+
+TEST(SimulationTests, Test_04_FightThreadResolvesCandidates) {
+    SimulationConfig config;
+    config.seed = 777;
+    config.population = {300, 300, 300};
+    config.max_x = config.max_y = 300;
+    config.ticks = 40;
+    config.fight_workers = 2;
+    config.fight_thread = true;
+
+    Simulation sim(config);
+    auto observer = std::make_shared<RecordingObserver>();
+    sim.events().subscribe(observer, FightFilter::WinsOnly);
+    SimulationResult result = sim.run();
+
+    // Порядок боёв зависит от потоков, но после finish() каждая победа
+    // учтена в мире и дошла до наблюдателя ровно один раз
+    size_t wins = 0;
+    for (auto &batch : observer->batches)
+        wins += batch.size();
+    ASSERT_GT(result.dead, 0u);
+    ASSERT_EQ(wins, result.dead);
+    ASSERT_EQ(result.knights + result.orcs + result.bears + result.dead, 900u);
+    ASSERT_EQ(sim.events().pending(), 0u);
+}
+
+TEST(TournamentTests, Test_01_WilsonInterval) {
+    WinRate half = wilson_interval(50, 100, 1.96);
+    ASSERT_DOUBLE_EQ(half.rate, 0.5);
+    ASSERT_NEAR(half.low, 0.4038, 1e-4);
+    ASSERT_NEAR(half.high, 0.5962, 1e-4);
+
+    WinRate none = wilson_interval(0, 20, 1.96);
+    ASSERT_DOUBLE_EQ(none.low, 0.0);
+    ASSERT_GT(none.high, 0.0);
+    ASSERT_EQ(wilson_interval(0, 0, 1.96).high, 0.0);
+}
+
+TEST(TournamentTests, Test_02_IndependentOfThreadCount) {
+    TournamentConfig config;
+    config.battle.population = {40, 40, 40};
+    config.battle.max_x = config.battle.max_y = 150;
+    config.battle.ticks = 40;
+    config.first_seed = 100;
+    config.battles = 24;
+
+    config.threads = 1;
+    TournamentResult serial = run_tournament(config);
+    config.threads = 4;
+    TournamentResult pooled = run_tournament(config);
+
+    size_t decided = serial.draws;
+    for (NpcType type : {OrcType, KnightType, BearType}) {
+        ASSERT_EQ(serial.factions[type].wins, pooled.factions[type].wins);
+        ASSERT_LE(serial.factions[type].low, serial.factions[type].rate);
+        ASSERT_GE(serial.factions[type].high, serial.factions[type].rate);
+        decided += serial.factions[type].wins;
+    }
+    ASSERT_EQ(decided, config.battles);
+    for (size_t i = 0; i < config.battles; ++i)
+        ASSERT_EQ(serial.results[i].checksum, pooled.results[i].checksum);
+
+    // Бой турнира - то же, что отдельный прогон с тем же зерном
+    SimulationConfig single = config.battle;
+    single.seed = config.first_seed + 5;
+    ASSERT_EQ(Simulation(single).run().checksum, serial.results[5].checksum);
+}
+
+TEST(PopulationTests, Test_01_CountersFollowKills) {
+    World world(100, 100);
+    auto knight = std::make_shared<Knight>(world, world.spawn(KnightType, 0, 0, "Arthur"));
+    world.spawn(OrcType, 1, 1, "Grom");
+    world.spawn(OrcType, 2, 2, "Mog");
+    ASSERT_EQ(world.alive_count(OrcType), 2u);
+    ASSERT_EQ(world.alive_count(KnightType), 1u);
+
+    knight->must_die();
+    knight->must_die(); // повторная смерть не считается
+    world.kill(1);
+    PopulationCounts counts = world.population();
+    ASSERT_EQ(counts.of(KnightType), 0u);
+    ASSERT_EQ(counts.of(OrcType), 1u);
+    ASSERT_EQ(counts.dead, 2u);
+    ASSERT_EQ(counts.total_alive(), 1u);
+
+    // Загрузка снимка пересчитывает счётчики по столбцам
+    auto path = (std::filesystem::temp_directory_path() / "lab7_population_test.l7ws").string();
+    ASSERT_TRUE(save_snapshot(world, path));
+    auto loaded = load_snapshot(path);
+    std::filesystem::remove(path);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(loaded->population().of(OrcType), 1u);
+    ASSERT_EQ(loaded->population().of(KnightType), 0u);
+    ASSERT_EQ(loaded->population().dead, 2u);
+}
+
+TEST(PopulationTests, Test_02_HistoryRing) {
+    PopulationHistory history(3);
+    PopulationCounts counts;
+    for (size_t tick = 0; tick < 5; ++tick) {
+        counts.alive[OrcType] = 10 - tick;
+        counts.dead = tick;
+        history.record(tick, counts);
+    }
+    ASSERT_EQ(history.size(), 3u);
+    ASSERT_EQ(history[0].tick, 2u);
+    ASSERT_EQ(history.back().tick, 4u);
+    ASSERT_EQ(history.back().alive[OrcType], 6u);
+
+    std::ostringstream csv;
+    history.export_csv(csv);
+    ASSERT_EQ(csv.str(), "tick,orcs,knights,bears,dead\n2,8,0,0,2\n3,7,0,0,3\n4,6,0,0,4\n");
+
+    SimulationConfig config;
+    config.seed = 3;
+    config.ticks = 20;
+    config.history_ticks = 8;
+    Simulation sim(config);
+    SimulationResult result = sim.run();
+    ASSERT_EQ(sim.history().size(), 8u);
+    ASSERT_EQ(sim.history().back().tick, 19u);
+    ASSERT_EQ(sim.history().back().dead, result.dead);
+}
+
+TEST(FrameRendererTests, Test_01_OneWritePerFrame) {
+    World world(40, 40);
+    world.spawn(KnightType, 0, 0, "Arthur");
+    world.spawn(OrcType, 39, 39, "Mo");
+    world.spawn(BearType, 20, 0, "Baloo");
+    world.kill(2);
+
+    auto path = std::filesystem::temp_directory_path() / "lab7_frame_test.txt";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    std::mutex console;
+    {
+        FrameRenderer renderer(2, fd, console);
+        renderer.capture(world, 7);
+        renderer.flush();
+        ASSERT_EQ(renderer.frames_written(), 1u);
+        ASSERT_EQ(renderer.write_calls(), 1u);
+    }
+    ::close(fd);
+
+    ASSERT_EQ(read_file(path),
+              "\n=== Turn  7 ===\nLegend: K=Knight, O=Orc, B=Bear, X=Dead\n"
+              "[KArt][XXXX]\n"
+              "[    ][OMo]\n"
+              "\nStatistics: Knights: 1, Orcs: 1, Bears: 0, Dead: 1, Total: 3\n");
+    std::filesystem::remove(path);
+}
+
+TEST(FrameRendererTests, Test_02_CaptureNeverWaits) {
+    World world(100, 100);
+    for (int i = 0; i < 50; ++i)
+        world.spawn(OrcType, i, i, "Grom");
+
+    auto log_path = std::filesystem::temp_directory_path() / "lab7_frame_log_test.txt";
+    int fd = ::open("/dev/null", O_WRONLY);
+    ASSERT_GE(fd, 0);
+    std::mutex console;
+    size_t written = 0, dropped = 0;
+    {
+        AsyncLogger log(log_path.string());
+        FrameRenderer renderer(10, fd, console, &log);
+        {
+            // Писатель стоит на мьютексе консоли, а кадры всё равно принимаются
+            std::lock_guard<std::mutex> hold(console);
+            for (size_t tick = 0; tick < 100; ++tick)
+                renderer.capture(world, tick);
+        }
+        renderer.flush();
+        written = renderer.frames_written();
+        dropped = renderer.frames_dropped();
+        log.flush();
+    }
+    ::close(fd);
+    ASSERT_EQ(written + dropped, 100u);
+    ASSERT_GE(dropped, 98u);
+    ASSERT_NE(read_file(log_path).find("=== Turn 99 ==="), std::string::npos);
+    std::filesystem::remove(log_path);
+}
+
+TEST(NameTableTests, Test_01_InternAndStableViews) {
+    NameTable names;
+    std::uint32_t grom = names.intern("Grom");
+    ASSERT_EQ(names.intern("Arthur"), 1u);
+    ASSERT_EQ(names.intern(std::string("Grom")), grom);
+    ASSERT_EQ(names.size(), 2u);
+
+    // Рост таблицы не двигает уже выданные строки
+    std::string_view first = names.view(grom);
+    const char *data = first.data();
+    for (int i = 0; i < 5000; ++i)
+        names.intern("name" + std::to_string(i));
+    ASSERT_EQ(names.size(), 5002u);
+    ASSERT_EQ(names.view(grom).data(), data);
+    ASSERT_EQ(first, "Grom");
+    ASSERT_EQ(names.view(4001), "name3999");
+
+    std::vector<std::string_view> loaded{"Mog", "Mog", "Baloo"};
+    names.assign(loaded);
+    ASSERT_EQ(names.size(), 3u);
+    ASSERT_EQ(names.view(1), "Mog");
+    ASSERT_EQ(names.intern("Mog"), 0u);
+    ASSERT_EQ(names.intern("Grom"), 3u);
+}
+
+TEST(NameTableTests, Test_02_ReadersDuringIntern) {
+    NameTable names;
+    names.intern("Grom");
+    std::atomic<bool> done{false};
+    std::thread reader([&names, &done] {
+        while (!done) {
+            size_t n = names.size();
+            for (size_t i = 0; i < n; i += 97)
+                ASSERT_FALSE(names.view(static_cast<std::uint32_t>(i)).empty());
+        }
+    });
+    for (int i = 0; i < 20000; ++i)
+        names.intern("n" + std::to_string(i));
+    done = true;
+    reader.join();
+
+    // Отдельные NPC делят общую таблицу: одинаковые имена - один id
+    Orc a(0, 0, "Grom"), b(5, 5, "Grom");
+    ASSERT_EQ(a.get_name().data(), b.get_name().data());
+    World world(10, 10);
+    Orc view(world, world.spawn(OrcType, 1, 1, "Thrak"));
+    ASSERT_EQ(view.get_name(), "Thrak");
+}
+
+TEST(SimdTests, Test_01_MoveMatchesWorldMove) {
+    // 1003 - не кратно 8: хвост идёт скалярно. Края карты, мёртвые,
+    // Unknown и типы вне перечисления
+    const int max = 100;
+    const size_t n = 1003;
+    CounterRng rng(11, 0);
+    World reference(max, max);
+    std::vector<int> xs(n), ys(n);
+    std::vector<std::uint8_t> types(n), alive(n), dirs(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = (i % 5 == 0) ? 0 : (i % 5 == 1) ? max : static_cast<int>(rng.uniform(max + 1));
+        ys[i] = (i % 7 == 0) ? max : static_cast<int>(rng.uniform(max + 1));
+        types[i] = static_cast<std::uint8_t>(rng.uniform(7));
+        alive[i] = rng.uniform(4) != 0;
+        dirs[i] = static_cast<std::uint8_t>(rng.uniform(4));
+        EntityId id = reference.spawn(static_cast<NpcType>(types[i]), xs[i], ys[i]);
+        if (!alive[i])
+            reference.kill(id);
+        reference.move(id, (dirs[i] & 1) ? 1 : -1, (dirs[i] & 2) ? 1 : -1);
+    }
+
+    for (auto level : {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2}) {
+        std::vector<int> x = xs, y = ys;
+        move_batch({x.data(), y.data(), types.data(), alive.data(), dirs.data(), DEFAULT_MOVE_RANGES, n},
+                   max, max, level);
+        for (EntityId id = 0; id < n; ++id) {
+            ASSERT_EQ(x[id], reference.x(id)) << simd_level_name(level) << " id " << id;
+            ASSERT_EQ(y[id], reference.y(id)) << simd_level_name(level) << " id " << id;
+        }
+    }
+
+    // move_all мира даёт то же, что поштучный move
+    World world(max, max);
+    for (size_t i = 0; i < n; ++i) {
+        EntityId id = world.spawn(static_cast<NpcType>(types[i]), xs[i], ys[i]);
+        if (!alive[i])
+            world.kill(id);
+    }
+    world.move_all(dirs);
+    for (EntityId id = 0; id < n; ++id)
+        ASSERT_EQ(world.position(id), reference.position(id));
+}
+
+TEST(SimdTests, Test_02_DistancesMatchScalar) {
+    const size_t n = 517;
+    CounterRng rng(5, 1);
+    std::vector<int> xs(n), ys(n);
+    std::vector<std::uint32_t> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = static_cast<int>(rng.uniform(1000));
+        ys[i] = static_cast<int>(rng.uniform(1000));
+        a[i] = rng.uniform(static_cast<std::uint32_t>(n));
+        b[i] = rng.uniform(static_cast<std::uint32_t>(n));
+    }
+    // Крайние координаты: квадрат разности не влезает в 32 бита
+    xs[0] = 2000000000;
+    xs[1] = -2000000000;
+    ys[2] = -1;
+    a[3] = 0;
+    b[3] = 1;
+    a[4] = 2;
+    b[4] = 0;
+
+    std::vector<std::uint64_t> expected(n);
+    squared_distances(xs.data(), ys.data(), a.data(), b.data(), n, expected.data(), SimdLevel::Scalar);
+    World world(1000, 1000);
+    for (size_t i = 0; i < n; ++i)
+        world.spawn(OrcType, xs[i], ys[i]);
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] > 2 && b[i] > 2) {
+            ASSERT_EQ(expected[i] <= 100, world.is_close(a[i], b[i], 10));
+        }
+    }
+
+    for (auto level : {SimdLevel::Sse41, SimdLevel::Avx2}) {
+        std::vector<std::uint64_t> out(n);
+        squared_distances(xs.data(), ys.data(), a.data(), b.data(), n, out.data(), level);
+        ASSERT_EQ(out, expected) << simd_level_name(level);
+    }
+}
+
+TEST(SimdTests, Test_03_ConfiguredRangesAndRadius) {
+    // Шаги не по умолчанию: ядра идут без констант, но совпадают с World::move
+    const MoveRanges ranges{3, 7, 1000, 0};
+    const int max = 2000;
+    const size_t n = 77;
+    CounterRng rng(3, 2);
+    World reference(max, max);
+    reference.set_move_ranges(ranges);
+    std::vector<int> xs(n), ys(n);
+    std::vector<std::uint8_t> types(n), alive(n, 1), dirs(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = static_cast<int>(rng.uniform(max + 1));
+        ys[i] = static_cast<int>(rng.uniform(max + 1));
+        types[i] = static_cast<std::uint8_t>(rng.uniform(5));
+        dirs[i] = static_cast<std::uint8_t>(rng.uniform(4));
+        EntityId id = reference.spawn(static_cast<NpcType>(types[i]), xs[i], ys[i]);
+        reference.move(id, (dirs[i] & 1) ? 1 : -1, (dirs[i] & 2) ? 1 : -1);
+    }
+    for (auto level : {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2}) {
+        std::vector<int> x = xs, y = ys;
+        move_batch({x.data(), y.data(), types.data(), alive.data(), dirs.data(), ranges, n}, max, max, level);
+        for (EntityId id = 0; id < n; ++id)
+            ASSERT_EQ(std::make_pair(x[id], y[id]), reference.position(id)) << simd_level_name(level);
+    }
+
+    // close_pairs: радиус по умолчанию (константа) и произвольный
+    std::vector<std::uint32_t> a(n * 4), b(n * 4), out(n * 4);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = rng.uniform(static_cast<std::uint32_t>(n));
+        b[i] = rng.uniform(static_cast<std::uint32_t>(n));
+    }
+    for (int distance : {DEFAULT_KILL_DISTANCE, 300}) {
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < a.size(); ++i) {
+            if (reference.is_close(a[i], b[i], distance))
+                expected.push_back(i);
+        }
+        auto rx = reference.x_data(), ry = reference.y_data();
+        size_t found = close_pairs(rx.data(), ry.data(), a.data(), b.data(), a.size(), distance, out.data());
+        ASSERT_EQ(std::vector<std::uint32_t>(out.begin(), out.begin() + found), expected) << distance;
+    }
+}
+
+TEST(ConfigTests, Test_01_ParseOverridesDefaults) {
+    std::istringstream is(
+        "# sweep\n"
+        "map = 800x600\n"
+        "kill_distance = 15   # и клетка сетки\n"
+        "\n"
+        "move.orc = 4\n"
+        "move.bear=0\n"
+        "render_grid = 32\n"
+        "orcs = 100\n");
+    GameConfig config;
+    ASSERT_TRUE(parse_config(is, config));
+    ASSERT_EQ(config.sim.max_x, 800);
+    ASSERT_EQ(config.sim.max_y, 600);
+    ASSERT_EQ(config.sim.distance, 15);
+    ASSERT_EQ(config.render_grid, 32);
+    ASSERT_EQ(config.sim.population.orcs, 100u);
+    ASSERT_EQ(config.sim.population.knights, 3u); // не задан - по умолчанию
+    ASSERT_EQ(config.sim.move_ranges, (MoveRanges{0, 4, 30, 0}));
+
+    // Шаги из конфигурации доходят до мира симуляции
+    config.sim.population = {20, 0, 0};
+    config.sim.ticks = 1;
+    config.sim.seed = 9;
+    Simulation sim(config.sim);
+    ASSERT_EQ(sim.get_world().move_ranges(), config.sim.move_ranges);
+    auto start = sim.get_world().position(0);
+    sim.run();
+    auto end = sim.get_world().position(0);
+    ASSERT_LE(std::abs(end.first - start.first), 4);
+    ASSERT_LE(std::abs(end.second - start.second), 4);
+}
+
+TEST(ConfigTests, Test_02_RejectsBadInput) {
+    for (const char *text : {"kill_distance = 0\n", "move.knight = -1\n", "map = 10x\n",
+                             "map = 800x600junk\n", "map = 800x600,5\n",
+                             "speed = 3\n", "ticks\n", "orcs = 5x\n"}) {
+        std::istringstream is(text);
+        GameConfig config;
+        ASSERT_FALSE(parse_config(is, config)) << text;
+    }
+    int w = 0, h = 0;
+    ASSERT_FALSE(parse_map_size("800x600junk", w, h));
+    ASSERT_TRUE(parse_map_size("800x600", w, h));
+    ASSERT_EQ(std::make_pair(w, h), std::make_pair(800, 600));
+    GameConfig config;
+    ASSERT_FALSE(load_config("no_such_config.cfg", config));
+}
+
+TEST(RegistryTests, Test_01_BuiltinsMatchOldTables) {
+    const NpcRegistry &registry = npc_registry();
+    ASSERT_GE(registry.size(), NPC_TYPE_COUNT);
+    for (size_t a = 0; a < NPC_TYPE_COUNT; ++a)
+        for (size_t d = 0; d < NPC_TYPE_COUNT; ++d)
+            ASSERT_EQ(registry.wins(a, d), fight_table[a][d]) << a << " vs " << d;
+    ASSERT_FALSE(registry.wins(KnightType, 200));
+
+    ASSERT_EQ(registry.glyph(KnightType), 'K');
+    ASSERT_EQ(registry.glyph(OrcType), 'O');
+    ASSERT_EQ(registry.glyph(BearType), 'B');
+    ASSERT_EQ(registry.glyph(Unknown), 0);
+    ASSERT_STREQ(type_name(OrcType), "Orc");
+    ASSERT_STREQ(type_name(static_cast<NpcType>(250)), "Unknown");
+    ASSERT_EQ(move_distance(KnightType), 30);
+    ASSERT_EQ(name_pool(BearType).size(), 10u);
+    ASSERT_EQ(registry.find("knight"), KnightType);
+    ASSERT_EQ(registry.find("Dragon"), Unknown);
+
+    // Реестр полон - add отказывает, ничего не меняя
+    NpcRegistry local;
+    for (size_t i = local.size(); i < MAX_NPC_TYPES; ++i)
+        ASSERT_NE(local.add({"Faction" + std::to_string(i), 'F', 1, {}}), Unknown);
+    ASSERT_EQ(local.add({"Overflow", 'V', 1, {}}), Unknown);
+    ASSERT_EQ(local.add({"Orc", 'V', 1, {}}), Unknown);
+    ASSERT_EQ(local.size(), MAX_NPC_TYPES);
+    ASSERT_EQ(local.info(static_cast<NpcType>(MAX_NPC_TYPES - 1)).names.size(), 1u);
+}
+
+TEST(RegistryTests, Test_02_NewFactionWithoutNewClasses) {
+    // Реестр общий для процесса: Elf не должен пережить тест
+    NpcRegistry &registry = npc_registry();
+    struct Restore {
+        size_t count;
+        ~Restore() { npc_registry().truncate(count); }
+    } restore{registry.size()};
+    NpcType elf = registry.add({"Elf", 'E', 7, {"Legolas", "Elrond"}});
+    registry.set_wins(elf, OrcType);
+    registry.set_wins(KnightType, elf);
+    ASSERT_NE(elf, Unknown);
+    ASSERT_STREQ(type_name(elf), "Elf");
+
+    // Мир после регистрации знает шаг и счётчики фракции
+    World world(100, 100);
+    ASSERT_EQ(world.move_ranges()[elf], 7);
+    EntityId e = world.spawn(elf, 50, 50, "Legolas");
+    EntityId orc = world.spawn(OrcType, 51, 50, "Grom");
+    EntityId knight = world.spawn(KnightType, 52, 50, "Arthur");
+    ASSERT_EQ(world.alive_count(elf), 1u);
+    world.move(e, 1, 1);
+    ASSERT_EQ(world.position(e), std::make_pair(57, 57));
+
+    // Текстовый снимок и конфигурация принимают тип по реестру
+    std::stringstream text;
+    save_text(world, text);
+    World loaded(100, 100);
+    ASSERT_EQ(load_text(loaded, text), 3u);
+    ASSERT_EQ(loaded.type(0), elf);
+
+    ASSERT_TRUE(resolve_in_world(world, {world.handle(e), world.handle(orc)}, nullptr));
+    ASSERT_FALSE(resolve_in_world(world, {world.handle(e), world.handle(knight)}, nullptr));
+    ASSERT_TRUE(resolve_in_world(world, {world.handle(knight), world.handle(e)}, nullptr));
+    ASSERT_EQ(world.alive_count(elf), 0u);
+    ASSERT_EQ(world.dead_count(), 2u);
+
+    std::istringstream cfg("spawn.elf = 12\nmove.elf = 3\n");
+    GameConfig config;
+    ASSERT_TRUE(parse_config(cfg, config));
+    config.sim.population = {0, 0, 0, config.sim.population.others};
+    config.sim.ticks = 1;
+    Simulation sim(config.sim);
+    ASSERT_EQ(sim.get_world().size(), 12u);
+    ASSERT_EQ(sim.get_world().move_ranges()[elf], 3);
+    ASSERT_EQ(sim.get_world().alive_count(elf), 12u);
+    ASSERT_EQ(npc_registry().glyph(sim.get_world().type(0)), 'E');
+}
+
+TEST(RegistryTests, Test_03_TruncateRollsBack) {
+    NpcRegistry registry;
+    NpcType elf = registry.add({"Elf", 'E', 7, {}});
+    registry.set_wins(elf, OrcType);
+    registry.set_wins(KnightType, elf);
+    registry.truncate(0); // встроенные остаются
+    ASSERT_EQ(registry.size(), NPC_TYPE_COUNT);
+    ASSERT_EQ(registry.find("Elf"), Unknown);
+    ASSERT_EQ(registry.glyph(elf), 0);
+    ASSERT_FALSE(registry.wins(elf, OrcType));
+    ASSERT_FALSE(registry.wins(KnightType, elf));
+    ASSERT_TRUE(registry.wins(KnightType, OrcType));
+    ASSERT_EQ(registry.add({"Elf", 'E', 7, {}}), elf);
+}
+
+TEST(MetricsTests, Test_01_HistogramPercentiles) {
+    LatencyHistogram h;
+    ASSERT_EQ(h.percentile(0.5), 0u);
+    for (std::uint64_t v = 1; v <= 100; ++v)
+        h.record(v);
+    ASSERT_EQ(h.count(), 100u);
+    ASSERT_EQ(h.sum(), 5050u);
+    ASSERT_EQ(h.max(), 100u);
+    // Квантиль - верхняя граница корзины: не меньше точного, не больше чем на 12.5%
+    ASSERT_GE(h.percentile(0.5), 50u);
+    ASSERT_LE(h.percentile(0.5), 57u);
+    ASSERT_EQ(h.percentile(0.99), 100u); // ограничен максимумом
+
+    for (std::uint64_t v : {0ull, 15ull, 16ull, 1000ull, 123456789ull, ~0ull}) {
+        size_t b = LatencyHistogram::bucket_of(v);
+        ASSERT_LT(b, LatencyHistogram::BUCKETS);
+        ASSERT_GE(LatencyHistogram::bucket_upper(b), v);
+        ASSERT_LE(LatencyHistogram::bucket_upper(b) - v, v / 8);
+    }
+
+    Metrics m;
+    m.add(MetricCounter::FightsResolved, 3);
+    m.histogram(MetricTimer::Detect).record(2000);
+    std::ostringstream json, prom;
+    m.export_json(json);
+    m.export_prometheus(prom);
+    ASSERT_NE(json.str().find("\"fights_resolved\": 3"), std::string::npos);
+    ASSERT_NE(json.str().find("\"detect\": {\"count\": 1"), std::string::npos);
+    ASSERT_NE(prom.str().find("lab7_fights_resolved_total 3\n"), std::string::npos);
+    ASSERT_NE(prom.str().find("lab7_phase_latency_seconds_count{phase=\"detect\"} 1\n"), std::string::npos);
+}
+
+TEST(MetricsTests, Test_02_SimulationCounters) {
+    metrics().reset();
+    SimulationConfig config;
+    config.seed = 4;
+    config.population = {300, 300, 300};
+    config.ticks = 25;
+    Simulation sim(config);
+    sim.run();
+
+    World &world = sim.get_world();
+    FightManager manager(world);
+    manager.add_event({world.handle(0), world.handle(1)});
+    manager.drain();
+
+    const Metrics &m = metrics();
+#ifdef LAB7_METRICS
+    ASSERT_EQ(m.histogram(MetricTimer::Move).count(), 25u);
+    ASSERT_EQ(m.histogram(MetricTimer::Fight).count(), 25u);
+    ASSERT_EQ(m.histogram(MetricTimer::FightBatch).count(), 1u);
+    ASSERT_GT(m.get(MetricCounter::FightsResolved), 0u);
+    // Каждое событие либо разобрано, либо отброшено
+    ASSERT_EQ(m.get(MetricCounter::FightsEnqueued),
+              m.get(MetricCounter::FightsResolved) + m.get(MetricCounter::FightsSkippedDead));
+#else
+    ASSERT_EQ(m.histogram(MetricTimer::Move).count(), 0u);
+    ASSERT_EQ(m.get(MetricCounter::FightsEnqueued), 0u);
+#endif
+    ASSERT_EQ(m.get(MetricCounter::FightsRequeued), 0u);
+}
+
+TEST(MetricsTests, Test_03_RequeueCountedOncePerEvent) {
+    World world(100, 100);
+    world.spawn(OrcType, 0, 0, "Grom");
+    world.spawn(BearType, 50, 50, "Baloo");
+    FightManager manager(world);
+    for (size_t i = 0; i < (1u << 16); ++i)
+        manager.add_event({world.handle(0), world.handle(1)});
+    metrics().reset();
+
+    // Очередь полна: событие ждёт, пока drain не освободит место
+    std::thread producer([&] { manager.add_event({world.handle(1), world.handle(0)}); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.drain();
+    producer.join();
+    manager.drain();
+#ifdef LAB7_METRICS
+    ASSERT_EQ(metrics().get(MetricCounter::FightsRequeued), 1u);
+#else
+    ASSERT_EQ(metrics().get(MetricCounter::FightsRequeued), 0u);
+#endif
+}
+
+TEST(SpawnTests, Test_01_RatesCapAndGrid) {
+    const SpawnRate rates[] = {{OrcType, 0.25}, {BearType, 2}, {KnightType, 0}};
+    SpawnStage stage(5, rates);
+    size_t orcs = 0;
+    for (size_t tick = 0; tick < 8; ++tick)
+        orcs += stage.planned(0, tick);
+    ASSERT_EQ(orcs, 2u); // дробная часть набегает
+
+    World world(100, 100);
+    SpatialGrid grid(100, 100, 10);
+    size_t born = 0;
+    for (size_t tick = 0; tick < 8; ++tick)
+        born += stage.run(world, grid, tick);
+    ASSERT_EQ(born, 18u);
+    ASSERT_EQ(world.alive_count(OrcType), 2u);
+    ASSERT_EQ(world.alive_count(BearType), 16u);
+    ASSERT_EQ(grid.size(), 18u);
+    ASSERT_EQ(world.live_ids().size(), 18u);
+
+    // Предел живых урезает пачку, освободившиеся слоты занимаются снова
+    SpawnStage capped(5, rates, 20);
+    ASSERT_EQ(capped.run(world, grid, 3), 2u);
+    ASSERT_EQ(capped.run(world, grid, 4), 0u);
+    for (EntityId id = 0; id < 5; ++id)
+        world.kill(id);
+    world.compact(4);
+    grid.remove_sorted(world.buried(), world.x_data(), world.y_data());
+    ASSERT_EQ(capped.run(world, grid, 5), 2u);
+    ASSERT_EQ(world.size(), 20u);
+    ASSERT_EQ(grid.size(), 17u);
+}
+
+TEST(SpawnTests, Test_02_SimulationStreamsDeterministically) {
+    GameConfig game;
+    std::istringstream cfg("rate.orc = 1.5\nrate.knight = 1\npopulation_cap = 150\n");
+    ASSERT_TRUE(parse_config(cfg, game));
+    ASSERT_EQ(game.sim.spawn_rates.size(), 2u);
+    ASSERT_EQ(game.sim.population_cap, 150u);
+    std::istringstream bad("rate.orc = -1\n");
+    ASSERT_FALSE(parse_config(bad, game));
+
+    SimulationConfig &config = game.sim;
+    config.seed = 99;
+    config.population = {0, 0, 0};
+    config.max_x = config.max_y = 200;
+    config.ticks = 100;
+    Simulation first(config);
+    Simulation second(config);
+    SimulationResult a = first.run();
+    SimulationResult b = second.run();
+    ASSERT_EQ(a.checksum, b.checksum);
+    ASSERT_GT(a.orcs + a.knights, 0u);
+    ASSERT_LE(a.orcs + a.knights, 150u);
+    ASSERT_EQ(a.bears, 0u);
+    // Все рождённые либо живы, либо на кладбище
+    const World &world = first.get_world();
+    ASSERT_EQ(world.live_ids().size() + world.graveyard().size(), a.orcs + a.knights + a.dead);
+}
+
+TEST(ChunkTests, Test_01_PageOutAndLazyReload) {
+    auto dir = std::filesystem::temp_directory_path() / "lab7_chunk_test";
+    std::filesystem::remove_all(dir);
+    SimulationConfig map;
+    map.max_x = map.max_y = 100000;
+    ChunkConfig config;
+    config.chunk_size = 100;
+    config.page_dir = dir.string();
+    {
+        ChunkedWorld world(map, config);
+        ASSERT_TRUE(world.spawn(OrcType, 10, 10, "Grom"));
+        ASSERT_TRUE(world.spawn(KnightType, 20, 30, "Arthur"));
+        ASSERT_TRUE(world.spawn(BearType, 50050, 99990, "Baloo"));
+        ASSERT_EQ(world.stats().resident, 2u);
+
+        // Бюджет на один чанк: трогаем первый - второй уходит на диск
+        world.set_memory_budget(world.stats().resident_bytes / 2);
+        world.touch(10, 10);
+        ASSERT_TRUE(world.is_paged(50050, 99990));
+        ASSERT_EQ(world.resident_chunk(50050, 99990), nullptr);
+        ASSERT_TRUE(std::filesystem::exists(dir / "chunk_500_999.l7ws"));
+        ASSERT_EQ(world.population(), 3u);
+
+        world.touch(50000, 99999);
+        ASSERT_TRUE(world.is_paged(10, 10));
+        const World *far = world.resident_chunk(50050, 99990);
+        ASSERT_NE(far, nullptr);
+        ASSERT_EQ(far->live_ids().size(), 1u);
+        EntityId id = far->live_ids()[0];
+        ASSERT_EQ(far->name(id), "Baloo");
+        ASSERT_EQ(far->position(id), std::make_pair(50050, 99990));
+
+        ChunkStats s = world.stats();
+        ASSERT_EQ(s.page_outs, 2u);
+        ASSERT_EQ(s.page_ins, 1u);
+        ASSERT_EQ(s.resident, 1u);
+        ASSERT_EQ(s.paged, 1u);
+        ASSERT_EQ(world.population(), 3u);
+    }
+    // Файлы выгруженных чанков удаляются вместе с миром
+    ASSERT_TRUE(std::filesystem::is_empty(dir));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ChunkTests, Test_02_MigrationLoadsNeighbour) {
+    SimulationConfig map;
+    map.seed = 4;
+    map.max_x = map.max_y = 1000;
+    map.move_ranges = {0, 30, 30, 30};
+    ChunkConfig config;
+    config.chunk_size = 100;
+    auto run = [](ChunkedWorld &world) {
+        for (int i = 0; i < 50; ++i)
+            world.spawn(OrcType, 95, 50 + i % 10);
+        world.spawn(BearType, 150, 50, "Baloo");
+        // Правый чанк на диске, пока в него не войдут
+        world.set_memory_budget(world.resident_chunk(95, 50)->memory_bytes());
+        world.touch(95, 50);
+        EXPECT_TRUE(world.is_paged(150, 50));
+        world.tick(0);
+    };
+    ChunkedWorld first(map, config);
+    ChunkedWorld second(map, config);
+    run(first);
+    run(second);
+
+    ASSERT_EQ(first.population(), 51u);
+    ASSERT_EQ(first.stats().page_ins, 1u);
+    const World *left = first.resident_chunk(50, 50);
+    const World *right = first.resident_chunk(150, 50);
+    ASSERT_NE(right, nullptr);
+    ASSERT_GT(right->live_ids().size(), 1u); // бурый и пришедшие орки
+    // Каждый NPC лежит в своём чанке, результат повторяется
+    for (const World *chunk : {left, right}) {
+        if (!chunk)
+            continue;
+        for (EntityId id : chunk->live_ids())
+            ASSERT_EQ(chunk->x(id) / 100, chunk == right ? 1 : 0);
+    }
+    ASSERT_EQ(right->live_ids().size(), second.resident_chunk(150, 50)->live_ids().size());
+}
+
+TEST(ChunkTests, Test_03_FightsAcrossBorders) {
+    SimulationConfig map;
+    map.seed = 9;
+    map.max_x = map.max_y = 10000;
+    map.move_ranges = {0, 0, 0, 0};
+    ChunkConfig config;
+    config.chunk_size = 100;
+    ChunkedWorld world(map, config);
+    world.spawn(KnightType, 10, 10, "Arthur");    // бой внутри чанка
+    world.spawn(OrcType, 12, 10, "Grom");
+    world.spawn(KnightType, 98, 50, "Lancelot");  // через границу по x
+    world.spawn(OrcType, 101, 50, "Mog");
+    world.spawn(OrcType, 195, 195, "Thrall");     // по диагонали
+    world.spawn(BearType, 201, 201, "Baloo");
+    world.spawn(BearType, 5000, 5000, "Yogi");
+    world.tick(0);
+
+    PopulationCounts c = world.counts();
+    ASSERT_EQ(c.of(KnightType), 2u);
+    ASSERT_EQ(c.of(OrcType), 1u); // Thrall убил медведя
+    ASSERT_EQ(c.of(BearType), 1u);
+    ASSERT_EQ(c.dead, 3u);
+    ASSERT_EQ(world.resident_chunk(10, 10)->graveyard().size(), 1u);
+    ASSERT_EQ(world.resident_chunk(101, 50), nullptr); // опустевший чанк удалён
+
+    // Выгрузка не теряет ни живых, ни погибших
+    world.set_memory_budget(1);
+    world.touch(5000, 5000);
+    ASSERT_TRUE(world.is_paged(10, 10));
+    c = world.counts();
+    ASSERT_EQ(c.total_alive(), 4u);
+    ASSERT_EQ(c.dead, 3u);
+    world.touch(10, 10);
+    ASSERT_EQ(world.counts().dead, 3u);
+    ASSERT_EQ(world.counts().of(OrcType), 1u);
+}
+
+TEST(ChunkTests, Test_04_PagedChunkIsFrozen) {
+    SimulationConfig map;
+    map.seed = 5;
+    map.max_x = map.max_y = 1000;
+    map.move_ranges = {0, 0, 3, 3};
+    ChunkConfig config;
+    config.chunk_size = 100;
+    ChunkedWorld world(map, config);
+    world.spawn(OrcType, 92, 50, "Grom");
+    EntityId bear = 1;
+    world.spawn(BearType, 20, 20, "Baloo");
+    world.spawn(KnightType, 550, 550, "Arthur");
+    // Рыцарь в соседнем выгруженном чанке в радиусе боя орка - боя нет
+    world.spawn(KnightType, 100, 50, "Lancelot");
+    world.set_memory_budget(world.resident_chunk(50, 50)->memory_bytes());
+    world.touch(50, 50);
+    ASSERT_TRUE(world.is_paged(550, 550));
+    ASSERT_TRUE(world.is_paged(100, 50));
+
+    for (size_t tick = 0; tick < 5; ++tick) {
+        world.touch(50, 50);
+        world.tick(tick);
+    }
+    ASSERT_EQ(world.counts().dead, 0u);
+    ASSERT_TRUE(world.is_paged(100, 50));
+    const World *home = world.resident_chunk(50, 50);
+    ASSERT_NE(home->position(bear), std::make_pair(20, 20));
+
+    // Загруженный обратно чанк продолжает с того места, где замер
+    world.set_memory_budget(64u << 20);
+    world.touch(550, 550);
+    const World *woken = world.resident_chunk(550, 550);
+    ASSERT_NE(woken, nullptr);
+    ASSERT_EQ(woken->position(woken->live_ids()[0]), std::make_pair(550, 550));
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}